@@ -28,11 +28,13 @@
 #include "utility/sqrt_integer.h"
 #include "utility/dspinst.h"
 
-// pull in the three stages of the fft algorithm.
+// pull in the three stages of the fft algorithm, specialized for 1024 points.
 extern "C" {
-    void arm_cfft_radix4_q15_stage1(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
-    void arm_cfft_radix4_q15_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
-    void arm_cfft_radix4_q15_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage1(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix8_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_q15_1024_twiddle_ram(q31_t * buffer);
 }
 
 // 140312 - PAH - slightly faster copy
@@ -46,17 +48,940 @@ static void copy_to_fft_buffer(void *destination, const void *source)
     }
 }
 
-static void apply_window_to_fft_buffer(void *buffer, const void *window)
+// The window is applied to two samples per iteration: a pair of window
+// values is one 32 bit load, each half multiplies one real sample and the
+// product is saturated back to 16 bits. A symmetric window holds only the
+// first 512 values and the second half of the frame reads them backwards.
+// Window tables must be 4 byte aligned, like the audio library ones.
+static void apply_window_to_fft_buffer(void *buffer, const void *window, bool symmetric)
 {
-    int16_t *buf = (int16_t *)buffer;
-    const int16_t *win = (int16_t *)window;;
+    uint32_t *buf = (uint32_t *)buffer;
+    const uint32_t *win = (const uint32_t *)window;
+    const int n = symmetric ? 256 : 512;
     
-    for (int i=0; i < 1024; i++) {
-        int32_t val = *buf * *win++;
-        //*buf = signed_saturate_rshift(val, 16, 15);
-        *buf = val >> 15;
+    for (int i=0; i < n; i++) {
+        uint32_t w = *win++;
+        int32_t val0 = multiply_16bx16b(buf[0], w);
+        int32_t val1 = multiply_16bx16t(buf[1], w);
+        buf[0] = (uint16_t)signed_saturate_rshift(val0, 16, 15);
+        buf[1] = (uint16_t)signed_saturate_rshift(val1, 16, 15);
         buf += 2;
     }
+    if (!symmetric) return;
+    for (int i=0; i < 256; i++) {
+        uint32_t w = *--win;
+        int32_t val0 = multiply_16bx16t(buf[0], w);
+        int32_t val1 = multiply_16bx16b(buf[1], w);
+        buf[0] = (uint16_t)signed_saturate_rshift(val0, 16, 15);
+        buf[1] = (uint16_t)signed_saturate_rshift(val1, 16, 15);
+        buf += 2;
+    }
+}
+
+static inline uint32_t window_complex(uint32_t b, int32_t w)
+{
+    int32_t re = signed_saturate_rshift(multiply_16bx16b(b, w), 16, 15);
+    int32_t im = signed_saturate_rshift(multiply_16tx16b(b, w), 16, 15);
+    return pack_16b_16b(im, re);
+}
+
+// same for zoom mode, real and imaginary part both take the window value
+static void apply_window_to_complex_buffer(void *buffer, const void *window, bool symmetric)
+{
+    uint32_t *buf = (uint32_t *)buffer;
+    const uint32_t *win = (const uint32_t *)window;
+    const int n = symmetric ? 256 : 512;
+    
+    for (int i=0; i < n; i++) {
+        uint32_t w = *win++;
+        buf[0] = window_complex(buf[0], w);
+        buf[1] = window_complex(buf[1], w >> 16);
+        buf += 2;
+    }
+    if (!symmetric) return;
+    for (int i=0; i < 256; i++) {
+        uint32_t w = *--win;
+        buf[0] = window_complex(buf[0], w >> 16);
+        buf[1] = window_complex(buf[1], w);
+        buf += 2;
+    }
+}
+
+// interpolated sine, same method as AudioSynthWaveformSine
+static inline int32_t nco_sine(uint32_t ph)
+{
+    uint32_t index = ph >> 24;
+    int32_t val1 = AudioWaveformSine[index];
+    int32_t val2 = AudioWaveformSine[index+1];
+    uint32_t scale = (ph >> 8) & 0xFFFF;
+    val2 *= scale;
+    val1 *= 0x10000 - scale;
+    return (val1 + val2) >> 16;
+}
+
+// cos(2*pi*m/1024) from the CMSIS twiddle table, stride is the table step
+// for one 1024th of a turn. The table only reaches 3/4 of a turn, so the
+// second half of the circle is folded back onto the first.
+static inline int32_t twiddle_cos(const q15_t *tw, uint32_t stride, uint32_t m)
+{
+    if (m > 512) m = 1024 - m;
+    return tw[stride * m];
+}
+
+// The fft is run without its bit reversal pass, so bin i sits at the
+// 10 bit reversed index. RBIT is a single instruction on the M4.
+static inline uint32_t bin_magsq(const int16_t *buf, int i)
+{
+    uint32_t tmp = *((uint32_t *)buf + (__RBIT(i) >> 22)); // real & imag
+    return multiply_16tx16t_add_16bx16b(tmp, tmp);
+}
+
+// log2(1 + i/64) in Q16, the last entry stands in for 65536
+static const uint16_t log2_table[65] = {
+    0, 1466, 2909, 4331, 5732, 7112, 8473, 9814,
+    11136, 12440, 13727, 14996, 16248, 17484, 18704, 19909,
+    21098, 22272, 23433, 24579, 25711, 26830, 27936, 29029,
+    30109, 31178, 32234, 33279, 34312, 35334, 36346, 37346,
+    38336, 39316, 40286, 41246, 42196, 43137, 44068, 44990,
+    45904, 46809, 47705, 48593, 49472, 50344, 51207, 52063,
+    52911, 53751, 54584, 55410, 56229, 57040, 57845, 58643,
+    59434, 60219, 60997, 61769, 62534, 63294, 64047, 64794,
+    65535
+};
+
+// 10 * log10(magsq / 2^28) in Q8 dB, so 0 dB is a bin that reads 1.0
+// through read(). CLZ gives the integer part of log2, the 6 bits below
+// the leading one pick the table entry and the next 16 interpolate it.
+static inline int16_t magsq_to_db(uint32_t magsq)
+{
+    if (magsq == 0) magsq = 1;
+    const uint32_t e = __builtin_clz(magsq);
+    const uint32_t n = magsq << e;
+    const uint32_t idx = (n >> 25) & 63;
+    const uint32_t frac = (n >> 9) & 0xFFFF;
+    int32_t lg = ((31 - e) << 16) + log2_table[idx];
+    lg += ((log2_table[idx+1] - log2_table[idx]) * frac) >> 16;
+    // 10 * log10(2) * 256 = 770.64 ~ 3083 / 4
+    return (((lg - (28 << 16)) >> 2) * 3083) >> 16;
+}
+
+// the value a bin stores in output[]
+static inline int16_t bin_output(uint32_t magsq, bool db)
+{
+    return db ? magsq_to_db(magsq) : sqrt_uint32_approx(magsq);
+}
+
+// |X| without the square root for FFT_SHED_CHEAP, 15/16 of the larger
+// part plus 15/32 of the smaller, within -6.25% and +3.9%
+static inline uint32_t bin_estimate(const int16_t *buf, int i)
+{
+    uint32_t tmp = *((uint32_t *)buf + (__RBIT(i) >> 22));
+    int32_t re = (int16_t)tmp, im = (int16_t)(tmp >> 16);
+    if (re < 0) re = -re;
+    if (im < 0) im = -im;
+    if (re < im) {
+        int32_t t = re;
+        re = im;
+        im = t;
+    }
+    return (re * 30 + im * 15) >> 5;
+}
+
+// magnitude loop, band sums are accumulated as the bins go by. output[i]
+// comes from fft bin (i + offset) & 1023, zoom mode centers its band with it.
+void AudioAnalyzeFFT1024_Fast::magnitudes(const int16_t *buf, int offset)
+{
+    const bool db = dbmode;
+    int i = 0;
+    if (shedlevel >= FFT_SHED_CHEAP) {
+        estimateMagnitudes(buf, offset);
+        return;
+    }
+    if (featureson) {
+        featureMagnitudes(buf, offset);
+        return;
+    }
+    if (bandcount) {
+        const bool store = !bandsonly;
+        for (; i < bandedge[0]; i++) {
+            uint32_t magsq = bin_magsq(buf, (i + offset) & 1023);
+            if (store) output[i] = bin_output(magsq, db);
+        }
+        // band sums stay linear
+        for (int b=0; b < bandcount; b++) {
+            uint32_t sum = 0;
+            for (int end = bandedge[b+1]; i < end; i++) {
+                uint32_t magsq = bin_magsq(buf, (i + offset) & 1023);
+                uint32_t mag = sqrt_uint32_approx(magsq);
+                if (store) output[i] = db ? magsq_to_db(magsq) : mag;
+                sum += mag;
+            }
+            bandoutput[b] = ((uint64_t)sum * bandweight[b]) >> 15;
+        }
+        if (!store) return;
+    }
+    for (; i < 512; i++) {
+        output[i] = bin_output(bin_magsq(buf, (i + offset) & 1023), db);
+    }
+}
+
+// The magnitude loop while shedding load: estimated magnitudes and band
+// sums, dB output keeps its CLZ log, which has no square root anyway.
+// The estimates are no base for flux, the next full frame publishes 0.
+void AudioAnalyzeFFT1024_Fast::estimateMagnitudes(const int16_t *buf, int offset)
+{
+    const bool db = dbmode;
+    const bool store = !(bandcount && bandsonly);
+    uint32_t sum = 0;
+    int b = 0;
+    
+    for (int i=0; i < 512; i++) {
+        const int k = (i + offset) & 1023;
+        const uint32_t mag = bin_estimate(buf, k);
+        if (store) output[i] = db ? magsq_to_db(bin_magsq(buf, k)) : mag;
+        if (b < bandcount && i >= bandedge[b]) {
+            sum += mag;
+            if (i + 1 == bandedge[b+1]) {
+                bandoutput[b] = ((uint64_t)sum * bandweight[b]) >> 15;
+                sum = 0;
+                b++;
+            }
+        }
+    }
+    featflux = 0;
+    fluxvalid = false;
+}
+
+// The magnitude loop with the spectral feature sums. Every bin needs its
+// linear magnitude, its power and its level in dB here, bands are summed
+// as the loop passes them. Flux compares against output[] before it is
+// overwritten, so no copy of the previous frame is kept, and output[] is
+// written even with bandsOnly. When output[] holds no comparable frame,
+// see fluxvalid, flux is published as 0. Power is also summed per 16 bins
+// so the rolloff search only rescans one chunk.
+void AudioAnalyzeFFT1024_Fast::featureMagnitudes(const int16_t *buf, int offset)
+{
+    const bool db = dbmode;
+    uint32_t magsum = 0, flux = 0, chunk = 0, bandsum = 0;
+    uint64_t magk = 0, pow = 0;
+    int32_t dbsum = 0;
+    int b = 0;
+    
+    for (int i=0; i < 512; i++) {
+        const uint32_t magsq = bin_magsq(buf, (i + offset) & 1023);
+        const uint32_t mag = sqrt_uint32_approx(magsq);
+        const int16_t level = magsq_to_db(magsq);
+        const int16_t val = db ? level : mag;
+        const int32_t d = val - output[i];
+        if (d > 0) flux += d;
+        output[i] = val;
+        magsum += mag;
+        magk += (uint64_t)mag * i;
+        pow += magsq;
+        dbsum += level;
+        chunk += magsq >> 10;
+        if ((i & 15) == 15) {
+            featchunk[i >> 4] = chunk;
+            chunk = 0;
+        }
+        if (b < bandcount && i >= bandedge[b]) {
+            bandsum += mag;
+            if (i + 1 == bandedge[b+1]) {
+                bandoutput[b] = ((uint64_t)bandsum * bandweight[b]) >> 15;
+                bandsum = 0;
+                b++;
+            }
+        }
+    }
+    featmag = magsum;
+    featmagk = magk;
+    featpow = pow;
+    featdb = dbsum;
+    featflux = fluxvalid ? flux : 0;
+    fluxvalid = true;
+    featoffset = offset;
+}
+
+// Rolloff, the lowest bin below which rollofffrac of the power lies. The
+// chunk sums find the 16 bins it falls in, those are read again from the
+// fft buffer, which still holds the frame.
+void AudioAnalyzeFFT1024_Fast::findRolloff(void)
+{
+    uint32_t total = 0, sum = 0;
+    int c = 0, k;
+    
+    for (int i=0; i < 32; i++) total += featchunk[i];
+    const uint32_t target = ((uint64_t)total * rollofffrac) >> 16;
+    for (; c < 31 && sum + featchunk[c] < target; c++) sum += featchunk[c];
+    for (k = c * 16; k < c * 16 + 15; k++) {
+        sum += bin_magsq(buffer, (k + featoffset) & 1023) >> 10;
+        if (sum >= target) break;
+    }
+    featrolloff = k;
+}
+
+void AudioAnalyzeFFT1024_Fast::features(bool enable, float rolloffFraction)
+{
+    if (rolloffFraction <= 0.0f) rolloffFraction = 0.85f;
+    if (rolloffFraction > 1.0f) rolloffFraction = 1.0f;
+    __disable_irq();
+    rollofffrac = rolloffFraction * 65535.0f;
+    featureson = enable;
+    fluxvalid = false;
+    __enable_irq();
+}
+
+float AudioAnalyzeFFT1024_Fast::flatness(void)
+{
+    if (featpow == 0) return 0.0;
+    // geometric over arithmetic mean of the power, both relative to 2^28
+    float geometric = powf(10.0f, featdb * (1.0f / (512.0f * 256.0f * 10.0f)));
+    float arithmetic = (float)featpow * (1.0f / (512.0f * 268435456.0f));
+    return geometric / arithmetic;
+}
+
+// Publishes a frame once the magnitude loop is done. The peak search and
+// the rolloff run first, or in the next update when defer is set, so the
+// flat schedule keeps them out of case 5.
+void AudioAnalyzeFFT1024_Fast::publish(bool defer)
+{
+    lastshed = false;
+    stampFrame();
+    if (!peakmax && !featureson) {
+        outputflag = true;
+        return;
+    }
+    if (shedlevel >= FFT_SHED_CHEAP) {
+        peakcount = 0;
+        outputflag = true;
+        return;
+    }
+    if (defer) {
+        postpending = true;
+        return;
+    }
+    if (peakmax) {
+        // bandsOnly leaves output[] holding an old frame, nothing to search
+        if (bandcount && bandsonly && !featureson) peakcount = 0;
+        else findPeaks();
+    }
+    if (featureson) findRolloff();
+    outputflag = true;
+}
+
+// Called when a frame's last block is in, first is its first sample. At
+// most one frame is in flight, so it holds until publish().
+void AudioAnalyzeFFT1024_Fast::latchFrame(uint64_t first, bool gap)
+{
+    pendingsample = first;
+    pendinghop = hopcount++;
+    pendinggap = gap;
+}
+
+// the latched frame becomes the one output[] holds
+void AudioAnalyzeFFT1024_Fast::stampFrame(void)
+{
+    framesample = pendingsample;
+    framehop = pendinghop;
+    framegap = pendinggap;
+    framescale = readscale;
+    framedb = dbmode;
+    frameshed = shedlevel;
+}
+
+void AudioAnalyzeFFT1024_Fast::peaks(uint8_t count, float threshold)
+{
+    if (count > FFT_MAX_PEAKS) count = FFT_MAX_PEAKS;
+    // kept in read() units and in dB, whichever outputDB() is on now
+    float linear = threshold, db = threshold;
+    if (dbmode) linear = powf(10.0f, threshold * (1.0f / 20.0f));
+    else db = threshold > 0.0f ? 20.0f * log10f(threshold) : -96.0f;
+    __disable_irq();
+    peakthreshold = linear;
+    peakthresholddb = db;
+    peakmax = count;
+    peakcount = 0;
+    __enable_irq();
+}
+
+// Local maxima of output[] above the threshold, the strongest peakmax are
+// kept sorted by level. Each is refined with a parabola through the bin
+// and its neighbours: offset p = (a - c) / (2 * (a - 2b + c)) in 1/256
+// bins and level b - (a - c) * p / 4.
+void AudioAnalyzeFFT1024_Fast::findPeaks(void)
+{
+    uint16_t bin[FFT_MAX_PEAKS];
+    int n = 0;
+    // the threshold in the units output[] has for this frame
+    float raw = framedb ? (peakthresholddb - dboffset) * 256.0f : peakthreshold / framescale;
+    if (raw > 32767.0f) raw = 32767.0f;
+    if (raw < -32768.0f) raw = -32768.0f;
+    const int32_t threshold = raw;
+    
+    for (int k=1; k < 511; k++) {
+        const int32_t b = output[k];
+        if (b <= threshold || b <= output[k-1] || b < output[k+1]) continue;
+        if (n == peakmax && b <= output[bin[n-1]]) continue;
+        int j = n < peakmax ? n++ : n - 1;
+        for (; j > 0 && output[bin[j-1]] < b; j--) bin[j] = bin[j-1];
+        bin[j] = k;
+    }
+    for (int i=0; i < n; i++) {
+        const int k = bin[i];
+        const int32_t a = output[k-1], b = output[k], c = output[k+1];
+        const int32_t den = a - 2 * b + c;
+        const int32_t p = den ? ((a - c) * 128) / den : 0;
+        peakpos[i] = (k << 8) + p;
+        peakval[i] = b - (((a - c) * p) >> 10);
+    }
+    peakcount = n;
+}
+
+uint8_t AudioAnalyzeFFT1024_Fast::bandMap(const uint16_t *edges, uint8_t count, const uint16_t *weights, bool bandsOnly)
+{
+    if (count > FFT_MAX_BANDS) count = FFT_MAX_BANDS;
+    // edges must climb and stay inside the 512 bins
+    for (int b=0; b < count; b++) {
+        if (edges[b+1] <= edges[b] || edges[b+1] > 512) {
+            count = b;
+            break;
+        }
+    }
+    __disable_irq();
+    for (int b=0; b <= count; b++) {
+        bandedge[b] = edges[b];
+    }
+    for (int b=0; b < count; b++) {
+        bandweight[b] = weights ? weights[b] : 32768;
+        bandoutput[b] = 0;
+    }
+    bandsonly = bandsOnly && count > 0;
+    bandcount = count;
+    __enable_irq();
+    return count;
+}
+
+uint8_t AudioAnalyzeFFT1024_Fast::bandMapFreq(const float *freq, uint8_t count, bool average, bool bandsOnly)
+{
+    uint16_t edges[FFT_MAX_BANDS+1];
+    uint16_t weights[FFT_MAX_BANDS];
+    const float binsPerHz = 1024.0f / AUDIO_SAMPLE_RATE_EXACT;
+    
+    for (int b=0; b <= count; b++) {
+        int bin = (int)(freq[b] * binsPerHz + 0.5f);
+        // an edge past Nyquist ends the band that straddles it at bin 512
+        if (bin > 512) bin = 512;
+        // bands narrower than one bin are widened to a whole bin
+        if (b > 0 && bin <= edges[b-1]) bin = edges[b-1] + 1;
+        // only when the bins run out is a band left off
+        if (bin > 512) {
+            count = b > 0 ? b - 1 : 0;
+            break;
+        }
+        edges[b] = bin;
+    }
+    for (int b=0; b < count; b++) {
+        weights[b] = average ? 32768 / (edges[b+1] - edges[b]) : 32768;
+    }
+    return bandMap(edges, count, weights, bandsOnly);
+}
+
+uint8_t AudioAnalyzeFFT1024_Fast::bandMapLog(uint8_t count, float freqLow, float freqHigh, bool average, bool bandsOnly)
+{
+    float freq[FFT_MAX_BANDS+1];
+    
+    if (count > FFT_MAX_BANDS) count = FFT_MAX_BANDS;
+    if (freqLow < 1.0f) freqLow = 1.0f;
+    const float ratio = powf(freqHigh / freqLow, 1.0f / count);
+    freq[0] = freqLow;
+    for (int b=1; b <= count; b++) {
+        freq[b] = freq[b-1] * ratio;
+    }
+    return bandMapFreq(freq, count, average, bandsOnly);
+}
+
+uint8_t AudioAnalyzeFFT1024_Fast::bandMapMel(uint8_t count, float freqLow, float freqHigh, bool average, bool bandsOnly)
+{
+    float freq[FFT_MAX_BANDS+1];
+    
+    if (count > FFT_MAX_BANDS) count = FFT_MAX_BANDS;
+    const float melLow = 2595.0f * log10f(1.0f + freqLow / 700.0f);
+    const float melHigh = 2595.0f * log10f(1.0f + freqHigh / 700.0f);
+    for (int b=0; b <= count; b++) {
+        float mel = melLow + (melHigh - melLow) * b / count;
+        freq[b] = 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+    }
+    return bandMapFreq(freq, count, average, bandsOnly);
+}
+
+// only called with the audio update masked, see zoom()
+void AudioAnalyzeFFT1024_Fast::releaseBlocks(void)
+{
+    int held = 0;
+    if (mode == FFT_MODE_FULL) held = state;
+    if (mode == FFT_MODE_ZOOM) held = zoompending;
+    if (mode == FFT_MODE_SLIDING) held = 8;
+    for (int i=0; i < held; i++) {
+        if (blocklist[i]) release(blocklist[i]);
+    }
+    for (int i=0; i < 8; i++) {
+        blocklist[i] = NULL;
+    }
+    state = 0;
+    primed = false;
+    workerstep = 0;
+    outputflag = false;
+    postpending = false;
+    zoompending = 0;
+    zoomstate = 0;
+    zoomfill = 0;
+}
+
+void AudioAnalyzeFFT1024_Fast::zoom(float centerFreq, uint8_t factor)
+{
+    uint8_t shift = 0;
+    while (shift < 7 && (2 << shift) <= factor) shift++;
+    
+    AudioNoInterrupts();
+    releaseBlocks();
+    zoomcenter = centerFreq;
+    zoomphaseinc = centerFreq * (4294967296.0 / AUDIO_SAMPLE_RATE_EXACT);
+    zoomphase = 0;
+    zoomre = 0;
+    zoomim = 0;
+    zoomcount = 0;
+    zoomshift = shift;
+    zoomfactor = 1 << shift;
+    mode = shift ? FFT_MODE_ZOOM : FFT_MODE_FULL;
+    fluxvalid = false;
+    AudioInterrupts();
+}
+
+// mix one block down to 0 Hz and decimate it into the complex fft buffer,
+// the decimation filter is a plain average of zoomfactor samples
+void AudioAnalyzeFFT1024_Fast::zoomMix(const int16_t *data, uint64_t number)
+{
+    int16_t *dst = buffer + 2 * zoomfill;
+    uint32_t ph = zoomphase;
+    const uint32_t inc = zoomphaseinc;
+    int32_t re = zoomre;
+    int32_t im = zoomim;
+    uint32_t n = zoomcount;
+    
+    for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        int32_t x = data[i];
+        re += (x * nco_sine(ph + 0x40000000)) >> 15;
+        im -= (x * nco_sine(ph)) >> 15;
+        ph += inc;
+        if (++n == zoomfactor) {
+            if (zoomfill == 0) {
+                // the first decimated sample averages the last zoomfactor
+                zoomstart = number * AUDIO_BLOCK_SAMPLES + i + 1 - zoomfactor;
+                zoomgap = false;
+            }
+            if (zoomfill < 1024) {
+                *dst++ = re >> zoomshift;
+                *dst++ = im >> zoomshift;
+                zoomfill++;
+            }
+            re = 0;
+            im = 0;
+            n = 0;
+        }
+    }
+    // an update without a block fell inside the frame
+    if (zoomfill && number != zoomlast + 1 && zoomstart < number * AUDIO_BLOCK_SAMPLES) zoomgap = true;
+    zoomlast = number;
+    zoomphase = ph;
+    zoomre = re;
+    zoomim = im;
+    zoomcount = n;
+}
+
+// A frame is 1024 decimated samples, so while the three fft stages run the
+// incoming blocks are held in blocklist and mixed down once the buffer is
+// free again.
+void AudioAnalyzeFFT1024_Fast::zoomUpdate(audio_block_t *block, uint64_t now)
+{
+    int16_t *buf = buffer;
+    if (zoomstate) slotblock[zoompending] = now;
+    switch (zoomstate) {
+        case 0:
+            for (int i=0; i < zoompending; i++) {
+                zoomMix(blocklist[i]->data, slotblock[i]);
+                release(blocklist[i]);
+            }
+            zoompending = 0;
+            zoomMix(block->data, now);
+            release(block);
+            if (zoomfill >= 1024) {
+                latchFrame(zoomstart, zoomgap);
+                zoomstate = 1;
+            }
+            break;
+        case 1:
+            blocklist[zoompending++] = block;
+            if (window) apply_window_to_complex_buffer(buf, window, windowhalf);
+            // stage 1 of the fft algorithm
+            arm_cfft_radix4_q15_1024_stage1(&fft_inst, buf);
+            zoomstate = 2;
+            break;
+        case 2:
+            blocklist[zoompending++] = block;
+            // stage 2 of the fft algorithm
+            stage2(buf);
+            zoomstate = 3;
+            break;
+        case 3:
+            blocklist[zoompending++] = block;
+            // stage 3 of the fft algorithm
+            arm_cfft_radix4_q15_1024_stage3(&fft_inst, buf);
+            // bins 768-1023 are below centerFreq, 0-255 above it
+            magnitudes(buf, 768);
+            publish(false);
+            zoomfill = 0;
+            zoomstate = 0;
+            break;
+    }
+}
+
+void AudioAnalyzeFFT1024_Fast::sparseBins(const uint16_t *bins, uint8_t count)
+{
+    if (count > FFT_MAX_SPARSE_BINS) count = FFT_MAX_SPARSE_BINS;
+    
+    AudioNoInterrupts();
+    releaseBlocks();
+    int n = 0;
+    for (int i=0; i < count; i++) {
+        if (bins[i] > 511) continue;
+        const float w = bins[i] * (2.0f * 3.14159265f / 1024.0f);
+        sparsebin[n] = bins[i];
+        // cos in Q30 so the DC bin still fits, sin only for the final step
+        sparsecos[n] = cosf(w) * 1073741824.0f;
+        sparsesin[n] = sinf(w) * 1073741823.0f;
+        sparses1[n] = 0;
+        sparses2[n] = 0;
+        n++;
+    }
+    memset(output, 0, sizeof(output));
+    sparsecount = n;
+    sparsepos = 0;
+    mode = n ? FFT_MODE_GOERTZEL : FFT_MODE_FULL;
+    fluxvalid = false;
+    AudioInterrupts();
+}
+
+// One Goertzel filter per registered bin, run over the 128 new samples of
+// every block so the cost is the same each update. Input is scaled down 2
+// bits so the filter state of bins 1 and up stays inside 32 bits, at most
+// about 2^30 for a full scale sine on bin 1. Bin 0 has a double pole, its
+// state would grow with n^2 past 32 bits, so it keeps the plain sum of the
+// samples in s1 instead, which is what s1 - s2 comes to there.
+void AudioAnalyzeFFT1024_Fast::goertzelUpdate(audio_block_t *block, uint64_t now)
+{
+    int32_t x[AUDIO_BLOCK_SAMPLES];
+    const int16_t *src = block->data;
+    
+    if (sparsepos == 0) slotblock[0] = now;
+    if (window && windowhalf && sparsepos >= 512) {
+        // second half of a symmetric window, read backwards
+        const int16_t *win = window + 1023 - sparsepos;
+        for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            x[i] = (src[i] * win[-i]) >> 17;
+        }
+    } else if (window) {
+        const int16_t *win = window + sparsepos;
+        for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            x[i] = (src[i] * win[i]) >> 17;
+        }
+    } else {
+        for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            x[i] = src[i] >> 2;
+        }
+    }
+    release(block);
+    
+    for (int b=0; b < sparsecount; b++) {
+        if (sparsebin[b] == 0) {
+            int32_t sum = 0;
+            for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) sum += x[i];
+            sparses1[b] += sum;
+            continue;
+        }
+        const int32_t c = sparsecos[b];
+        int32_t s1 = sparses1[b];
+        int32_t s2 = sparses2[b];
+        for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            int32_t s0 = x[i] + (int32_t)(((int64_t)c * s1) >> 29) - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        sparses1[b] = s1;
+        sparses2[b] = s2;
+    }
+    
+    sparsepos += AUDIO_BLOCK_SAMPLES;
+    if (sparsepos < 1024) return;
+    // end of frame, same scaling as the fft: |X| / 1024, less the 2 bits above
+    for (int b=0; b < sparsecount; b++) {
+        int32_t s1 = sparses1[b];
+        int32_t s2 = sparses2[b];
+        int32_t re = (s1 - (((int64_t)sparsecos[b] * s2) >> 30)) >> 8;
+        int32_t im = (((int64_t)sparsesin[b] * s2) >> 30) >> 8;
+        re = __SSAT(re, 16);
+        im = __SSAT(im, 16);
+        output[sparsebin[b]] = bin_output((uint32_t)(re * re) + (uint32_t)(im * im), dbmode);
+        sparses1[b] = 0;
+        sparses2[b] = 0;
+    }
+    sparsepos = 0;
+    latchFrame(slotblock[0] * AUDIO_BLOCK_SAMPLES, now - slotblock[0] != 7);
+    stampFrame();
+    outputflag = true;
+}
+
+void AudioAnalyzeFFT1024_Fast::slidingBins(const uint16_t *bins, uint8_t count, bool hann)
+{
+    if (count > FFT_MAX_SLIDING_BINS) count = FFT_MAX_SLIDING_BINS;
+    
+    AudioNoInterrupts();
+    releaseBlocks();
+    int n = 0, tracks = 0;
+    for (int i=0; i < count; i++) {
+        if (bins[i] > 511) continue;
+        slidebin[n] = bins[i];
+        for (int t=0; t < 3; t++) {
+            uint16_t k = (bins[i] + t - 1) & 1023;
+            if (!hann) k = bins[i];
+            int j = 0;
+            while (j < tracks && slidek[j] != k) j++;
+            if (j == tracks) {
+                slidek[j] = k;
+                slidere[j] = 0;
+                slideim[j] = 0;
+                tracks++;
+            }
+            slidetap[n][t] = j;
+        }
+        n++;
+    }
+    memset(output, 0, sizeof(output));
+    slidecount = n;
+    slidetracks = tracks;
+    slidehann = hann;
+    slidepos = 0;
+    mode = n ? FFT_MODE_SLIDING : FFT_MODE_FULL;
+    fluxvalid = false;
+    AudioInterrupts();
+}
+
+// Each tracker keeps S = sum of x[n] * W^(k*n) over the last 1024 samples
+// with n counted modulo 1024 from the start of the stream. A sample leaves
+// the window with the same rounded twiddle it came in with, so S stays
+// exact in integer math and never drifts. The 8 blocks of history sit in
+// blocklist.
+void AudioAnalyzeFFT1024_Fast::slidingUpdate(audio_block_t *block, uint64_t now)
+{
+    int32_t delta[AUDIO_BLOCK_SAMPLES];
+    const int slot = slidepos >> 7;
+    audio_block_t *old = blocklist[slot];
+    const q15_t *tw = fft_inst.pTwiddle;
+    const uint32_t stride = 2 * fft_inst.twidCoefModifier;
+    
+    for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        delta[i] = block->data[i] - (old ? old->data[i] : 0);
+    }
+    if (old) release(old);
+    blocklist[slot] = block;
+    slotblock[slot] = now;
+    
+    for (int j=0; j < slidetracks; j++) {
+        const uint32_t k = slidek[j];
+        uint32_t m = (k * slidepos) & 1023;
+        int64_t re = slidere[j];
+        int64_t im = slideim[j];
+        for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
+            re += delta[i] * twiddle_cos(tw, stride, m);
+            im -= delta[i] * twiddle_cos(tw, stride, (m - 256) & 1023);
+            m = (m + k) & 1023;
+        }
+        slidere[j] = re;
+        slideim[j] = im;
+    }
+    slidepos = (slidepos + AUDIO_BLOCK_SAMPLES) & 1023;
+    
+    // The window now starts at slidepos. Hann in the frequency domain is
+    // S[k]/2 - (S[k-1] * W^n0 + S[k+1] * W^-n0)/4, the rotation by n0 only
+    // lines the neighbours up with the window start.
+    const int64_t c = twiddle_cos(tw, stride, slidepos);
+    const int64_t s = twiddle_cos(tw, stride, (slidepos - 256) & 1023);
+    for (int b=0; b < slidecount; b++) {
+        const int j = slidetap[b][1];
+        int64_t re = slidere[j];
+        int64_t im = slideim[j];
+        if (slidehann) {
+            const int lo = slidetap[b][0];
+            const int hi = slidetap[b][2];
+            // S[k-1] * (c - js) + S[k+1] * (c + js), in Q15
+            int64_t nre = (slidere[lo] * c + slideim[lo] * s + slidere[hi] * c - slideim[hi] * s) >> 15;
+            int64_t nim = (slideim[lo] * c - slidere[lo] * s + slideim[hi] * c + slidere[hi] * s) >> 15;
+            re = (re >> 1) - (nre >> 2);
+            im = (im >> 1) - (nim >> 2);
+        }
+        // S carries the Q15 twiddle, the fft output is |X| / 1024
+        int32_t r = __SSAT((int32_t)(re >> 25), 16);
+        int32_t i = __SSAT((int32_t)(im >> 25), 16);
+        output[slidebin[b]] = bin_output((uint32_t)(r * r) + (uint32_t)(i * i), dbmode);
+    }
+    // the oldest block, the slot the next one replaces
+    const int oldest = slidepos >> 7;
+    if (blocklist[oldest]) {
+        latchFrame(slotblock[oldest] * AUDIO_BLOCK_SAMPLES, now - slotblock[oldest] != 7);
+    } else {
+        latchFrame(now >= 7 ? (now - 7) * AUDIO_BLOCK_SAMPLES : 0, true);
+    }
+    stampFrame();
+    outputflag = true;
+}
+
+void AudioAnalyzeFFT1024_Fast::schedule(uint8_t p, bool useYield)
+{
+    if (p > FFT_SCHEDULE_DEFERRED) return;
+    AudioNoInterrupts();
+    releaseBlocks();
+    if (p == FFT_SCHEDULE_HYBRID || p == FFT_SCHEDULE_DEFERRED) {
+        worker.setContext(this);
+        if (useYield) {
+            worker.attach(workerEvent);
+        } else {
+            // below the audio library's software interrupt (208)
+            worker.attachInterrupt(workerEvent, 240);
+        }
+    }
+    workeryield = useYield;
+    policy = p;
+    AudioInterrupts();
+}
+
+// Worker for the hybrid and deferred schedules. From the software interrupt
+// it finishes the frame in one go, from yield() it does one step and asks
+// to be called again.
+void AudioAnalyzeFFT1024_Fast::workerEvent(EventResponderRef event)
+{
+    AudioAnalyzeFFT1024_Fast *fft = (AudioAnalyzeFFT1024_Fast *)event.getContext();
+    
+    do {
+        fft->workerStep();
+    } while (fft->workerstep && !fft->workeryield);
+    if (fft->workerstep) event.triggerEvent();
+}
+
+void AudioAnalyzeFFT1024_Fast::workerStep(void)
+{
+    int16_t *buf = buffer;
+    switch (workerstep) {
+        case 1:
+            if (window) apply_window_to_fft_buffer(buf, window, windowhalf);
+            // stage 1 of the fft algorithm
+            arm_cfft_radix4_q15_1024_stage1(&fft_inst, buf);
+            workerstep = 2;
+            break;
+        case 2:
+            // stage 2 of the fft algorithm
+            stage2(buf);
+            workerstep = 3;
+            break;
+        case 3:
+            // stage 3 of the fft algorithm
+            arm_cfft_radix4_q15_1024_stage3(&fft_inst, buf);
+            magnitudes(buf, 0);
+            publish(false);
+            workerstep = 0;
+            break;
+    }
+}
+
+void AudioAnalyzeFFT1024_Fast::calibration(bool calibrate)
+{
+    float scale = 1.0 / 16384.0;
+    if (calibrate) scale /= windowGain(window, 1024, windowhalf);
+    readscale = scale;
+    dboffset = 20.0f * log10f(scale * 16384.0f);
+}
+
+void AudioAnalyzeFFT1024_Fast::kernel(uint8_t k)
+{
+    if (k != FFT_KERNEL_RADIX8) k = FFT_KERNEL_RADIX4;
+    fftkernel = k;
+}
+
+void AudioAnalyzeFFT1024_Fast::twiddlesInRAM(int32_t *buffer)
+{
+    arm_cfft_q15_1024_twiddle_ram(buffer);
+}
+
+void AudioAnalyzeFFT1024_Fast::stage2(int16_t *buf)
+{
+    if (fftkernel == FFT_KERNEL_RADIX8) arm_cfft_radix8_q15_1024_stage2(&fft_inst, buf);
+    else arm_cfft_radix4_q15_1024_stage2(&fft_inst, buf);
+}
+
+void AudioAnalyzeFFT1024_Fast::budget(uint32_t cycles, uint8_t maxShed)
+{
+    if (maxShed > FFT_SHED_CHEAP) maxShed = FFT_SHED_CHEAP;
+    AudioNoInterrupts();
+    cyclebudget = cycles;
+    shedmax = maxShed;
+    shedlevel = FFT_SHED_NONE;
+    calmcount = 0;
+    lastshed = false;
+    overbudgetcount = 0;
+    shedframecount = 0;
+    degradecount = 0;
+    memset(slotcycles, 0, sizeof(slotcycles));
+    AudioInterrupts();
+}
+
+// Called at the end of each fft update with the state it ran in. An update
+// over budget raises the shed level and, from SKIP on, drops what is left
+// of the frame it worked on: the flat schedule's middle and last stages,
+// or the worker before it has started. The frame after a dropped one is
+// always finished, so a budget that is too small still gets output. The
+// zoom, sparse and sliding modes are only timed and counted, their cost
+// is the same every block and none of the levels would lower it.
+void AudioAnalyzeFFT1024_Fast::checkBudget(uint8_t slot, uint32_t cycles)
+{
+    if (cycles > slotcycles[slot]) slotcycles[slot] = cycles;
+    if (!cyclebudget) return;
+    if (slot == FFT_SLOT_MODE) {
+        if (cycles > cyclebudget) overbudgetcount++;
+        return;
+    }
+    if (cycles > cyclebudget) {
+        overbudgetcount++;
+        calmcount = 0;
+        if (shedlevel < shedmax) {
+            shedlevel++;
+            degradecount++;
+            fluxvalid = false;
+        }
+        if (shedlevel < FFT_SHED_SKIP || lastshed) return;
+        if (policy == FFT_SCHEDULE_FLAT && primed && (slot == 7 || slot == 4)) {
+            primed = false;
+            shedframecount++;
+            lastshed = true;
+        } else if (slot == 7 && workerstep) {
+            workerstep = 0;
+            shedframecount++;
+            lastshed = true;
+        }
+    } else if (cycles > cyclebudget - (cyclebudget >> 2)) {
+        calmcount = 0;
+    } else if (slot == 7 && shedlevel && ++calmcount >= FFT_SHED_RECOVER) {
+        shedlevel--;
+        calmcount = 0;
+        fluxvalid = false;
+    }
 }
 
 void AudioAnalyzeFFT1024_Fast::update(void)
@@ -64,10 +989,22 @@ void AudioAnalyzeFFT1024_Fast::update(void)
     audio_block_t *block;
     
     block = receiveReadOnly();
+    // every update counts for the frame timestamps, with or without a block
+    const uint64_t now = updates++;
     if (!block) return;
     
 #if defined(KINETISK)
+    const uint32_t start = ARM_DWT_CYCCNT;
+    if (mode != FFT_MODE_FULL) {
+        if (mode == FFT_MODE_ZOOM) zoomUpdate(block, now);
+        else if (mode == FFT_MODE_GOERTZEL) goertzelUpdate(block, now);
+        else slidingUpdate(block, now);
+        checkBudget(FFT_SLOT_MODE, ARM_DWT_CYCCNT - start);
+        return;
+    }
     int16_t *buf = buffer;
+    const uint8_t slot = state;
+    slotblock[state] = now;
     switch (state) {
         case 0:
             blocklist[0] = block;
@@ -88,30 +1025,48 @@ void AudioAnalyzeFFT1024_Fast::update(void)
         case 4:
             blocklist[4] = block;
             // stage 2 of the fft algorithm
-            arm_cfft_radix4_q15_stage2(&fft_inst, buf);
+            if (primed) stage2(buf);
             state = 5;
             break;
         case 5:
             blocklist[5] = block;
+            // only the flat schedule has stages left here, and no frame is
+            // in the buffer until case 7 has run once
+            if (!primed) {
+                state = 6;
+                break;
+            }
             // stage 3 of the fft algorithm
-            arm_cfft_radix4_q15_stage3(&fft_inst, buf);
+            arm_cfft_radix4_q15_1024_stage3(&fft_inst, buf);
             // TODO: support averaging multiple copies
-            for (int i=0; i < 512; i++) {
-                uint32_t tmp = *((uint32_t *)buf + i); // real & imag
-                uint32_t magsq = multiply_16tx16t_add_16bx16b(tmp, tmp);
-                output[i] = sqrt_uint32_approx(magsq);
-            }
-            outputflag = true;
+            magnitudes(buf, 0);
+            publish(true);
             state = 6;
             break;
         case 6:
             blocklist[6] = block;
+            // the peak search and rolloff deferred from case 5
+            if (postpending) {
+                postpending = false;
+                publish(false);
+            }
             state = 7;
             break;
         case 7:
             blocklist[7] = block;
-            // TODO: perhaps distribute the work over multiple update() ??
-            //       github pull requsts welcome......
+            // the worker still owns the buffer, drop this frame
+            if (workerstep) {
+                overruncount++;
+                hopcount++;
+                goto next_frame;
+            }
+            // FFT_SHED_HOP computes every other frame only
+            if (shedlevel >= FFT_SHED_HOP && (hopskip = !hopskip)) {
+                primed = false;
+                shedframecount++;
+                hopcount++;
+                goto next_frame;
+            }
             copy_to_fft_buffer(buf+0x000, blocklist[0]->data);
             copy_to_fft_buffer(buf+0x100, blocklist[1]->data);
             copy_to_fft_buffer(buf+0x200, blocklist[2]->data);
@@ -120,9 +1075,27 @@ void AudioAnalyzeFFT1024_Fast::update(void)
             copy_to_fft_buffer(buf+0x500, blocklist[5]->data);
             copy_to_fft_buffer(buf+0x600, blocklist[6]->data);
             copy_to_fft_buffer(buf+0x700, blocklist[7]->data);
-            if (window) apply_window_to_fft_buffer(buf, window);
+            latchFrame(slotblock[0] * AUDIO_BLOCK_SAMPLES, now - slotblock[0] != 7);
+            if (policy == FFT_SCHEDULE_DEFERRED) {
+                workerstep = 1;
+                worker.triggerEvent();
+                goto next_frame;
+            }
+            if (window) apply_window_to_fft_buffer(buf, window, windowhalf);
             // stage 1 of the fft algorithm
-            arm_cfft_radix4_q15_stage1(&fft_inst, buf);
+            arm_cfft_radix4_q15_1024_stage1(&fft_inst, buf);
+            if (policy == FFT_SCHEDULE_FLAT) {
+                primed = true;
+            } else if (policy == FFT_SCHEDULE_LOW_LATENCY) {
+                stage2(buf);
+                arm_cfft_radix4_q15_1024_stage3(&fft_inst, buf);
+                magnitudes(buf, 0);
+                publish(false);
+            } else {
+                workerstep = 2;
+                worker.triggerEvent();
+            }
+        next_frame:
             release(blocklist[0]);
             release(blocklist[1]);
             release(blocklist[2]);
@@ -131,9 +1104,14 @@ void AudioAnalyzeFFT1024_Fast::update(void)
             blocklist[1] = blocklist[5];
             blocklist[2] = blocklist[6];
             blocklist[3] = blocklist[7];
+            slotblock[0] = slotblock[4];
+            slotblock[1] = slotblock[5];
+            slotblock[2] = slotblock[6];
+            slotblock[3] = slotblock[7];
             state = 4;
             break;
     }
+    checkBudget(slot, ARM_DWT_CYCCNT - start);
 #else
     release(block);
 #endif
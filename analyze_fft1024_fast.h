@@ -30,6 +30,8 @@
 #include "Arduino.h"
 #include "AudioStream.h"
 #include "arm_math.h"
+#include "EventResponder.h"
+#include "fft_window.h"
 
 // windows.c
 extern "C" {
@@ -46,7 +48,74 @@ extern "C" {
     extern const int16_t AudioWindowTukey1024[];
 }
 
-// pull in the three stages of the fft algorithm.
+// data_waveforms.c
+extern "C" {
+    extern const int16_t AudioWaveformSine[257];
+}
+
+// maximum number of bands a band map can publish
+#define FFT_MAX_BANDS 64
+// maximum number of bins sparseBins() can track
+#define FFT_MAX_SPARSE_BINS 16
+// maximum number of bins slidingBins() can track
+#define FFT_MAX_SLIDING_BINS 8
+// maximum number of peaks peaks() can report
+#define FFT_MAX_PEAKS 8
+
+// analysis modes
+#define FFT_MODE_FULL       0
+#define FFT_MODE_ZOOM       1
+#define FFT_MODE_GOERTZEL   2
+#define FFT_MODE_SLIDING    3
+
+// Scheduling of the fft stages, worst case is the heaviest single update().
+// The costs are host medians from fft_replay, see the README, on a Teensy
+// slotCycles() gives each state's worst case in cycles.
+// FLAT:        copy, window and stage 1 in case 7, the middle passes in case
+//              4, the last pass and magnitudes in case 5. Each
+//              update carries about a third of the fft (case 4, 8.0 us),
+//              frames are published 2 blocks after their last block.
+// LOW_LATENCY: the whole fft and the magnitudes in case 7, like the stock
+//              AudioAnalyzeFFT1024. No added latency, 0 blocks, the worst
+//              case update carries the entire fft (21.2 us).
+// HYBRID:      case 7 does the copy, window and stage 1 like FLAT (5.4 us),
+//              then a low priority software interrupt finishes the frame as
+//              soon as the audio update is done, 0 blocks.
+// DEFERRED:    case 7 only copies the 8 blocks into the fft buffer (0.7
+//              us), window, all three stages and the magnitudes run in the
+//              worker, 0 blocks. The audio interrupt carries no fft work.
+// The HYBRID and DEFERRED worker can also be polled from yield() instead of
+// a software interrupt, it then runs one stage per yield(). Either way one
+// frame is in flight at most, a frame that arrives while the worker still
+// owns the buffer is dropped and counted by overruns().
+#define FFT_SCHEDULE_FLAT          0
+#define FFT_SCHEDULE_LOW_LATENCY   1
+#define FFT_SCHEDULE_HYBRID        2
+#define FFT_SCHEDULE_DEFERRED      3
+
+// load shedding levels, see budget(), each one includes those before it
+// SKIP:   an update over budget drops the rest of the frame in flight
+// HOP:    only every other frame is computed, half the frame rate
+// CHEAP:  magnitudes are estimated without the square root (within 7%),
+//         peaks and features are not searched
+#define FFT_SHED_NONE              0
+#define FFT_SHED_SKIP              1
+#define FFT_SHED_HOP               2
+#define FFT_SHED_CHEAP             3
+// hops with a quarter of the budget to spare before stepping back a level
+#define FFT_SHED_RECOVER           32
+// slotCycles() of the zoom, sparse and sliding modes, 0 to 7 are the fft
+// states
+#define FFT_SLOT_MODE              8
+
+// middle stage kernels, see kernel()
+#define FFT_KERNEL_RADIX4          0
+#define FFT_KERNEL_RADIX8          1
+// words of the buffer twiddlesInRAM() takes, both packed twiddle tables
+#define FFT_TWIDDLE_RAM_WORDS      ((256 + 64 + 16 + 4) * 3 + (32 + 4) * 7)
+
+// pull in the three stages of the fft algorithm. The fast init copies a
+// const 1024 point instance, no CMSIS init runs for it.
 extern "C" {
     arm_status arm_cfft_radix4_init_fast_q15(arm_cfft_radix4_instance_q15 * S, uint16_t fftLen, uint8_t ifftFlag, uint8_t bitReverseFlag);
 }
@@ -55,8 +124,20 @@ class AudioAnalyzeFFT1024_Fast : public AudioStream
 {
 public:
     AudioAnalyzeFFT1024_Fast() : AudioStream(1, inputQueueArray),
-    window(AudioWindowHanning1024), state(0), outputflag(false), firstrun(true) {
-        arm_cfft_radix4_init_q15(&fft_inst, 1024, 0, 1);
+    window(AudioWindowHanning1024), windowhalf(false), readscale(1.0 / 16384.0), dboffset(0), dbmode(false), state(0), outputflag(false),
+    primed(false), workerstep(0), mode(FFT_MODE_FULL), policy(FFT_SCHEDULE_FLAT),
+    fftkernel(FFT_KERNEL_RADIX4),
+    workeryield(false), overruncount(0),
+    cyclebudget(0), overbudgetcount(0), shedframecount(0), degradecount(0),
+    shedmax(FFT_SHED_NONE), shedlevel(FFT_SHED_NONE), calmcount(0), hopskip(false), lastshed(false),
+    updates(0), hopcount(0), pendingsample(0), pendinghop(0), pendinggap(false),
+    framesample(0), framehop(0), framegap(false), framescale(1.0 / 16384.0), framedb(false), frameshed(FFT_SHED_NONE),
+    bandcount(0), bandsonly(false), peakthreshold(0), peakthresholddb(-96.0f), peakmax(0), peakcount(0), postpending(false),
+    featmagk(0), featpow(0), featmag(0), featflux(0), featdb(0), featrolloff(0), rollofffrac(55705),
+    featoffset(0), featureson(false), fluxvalid(false) {
+        arm_cfft_radix4_init_fast_q15(&fft_inst, 1024, 0, 0);
+        memset(slotcycles, 0, sizeof(slotcycles));
+        memset(slotblock, 0, sizeof(slotblock));
     }
     bool available() {
         if (outputflag == true) {
@@ -67,7 +148,7 @@ public:
     }
     float read(unsigned int binNumber) {
         if (binNumber > 511) return 0.0;
-        return (float)(output[binNumber]) * (1.0 / 16384.0);
+        return (float)(output[binNumber]) * readscale;
     }
     float read(unsigned int binFirst, unsigned int binLast) {
         if (binFirst > binLast) {
@@ -81,25 +162,314 @@ public:
         do {
             sum += output[binFirst++];
         } while (binFirst <= binLast);
-        return (float)sum * (1.0 / 16384.0);
+        return (float)sum * readscale;
+    }
+    // dB output: output[] holds 10 * log10(|X|^2) in Q8 dB (1/256 dB
+    // steps) computed in the update with an integer log2, no square root
+    // and no float log. 0 dB is a bin that reads 1.0 through read(), the
+    // floor is about -84 dB. read() is not meaningful while it is on.
+    void outputDB(bool enable) {
+        if (enable != dbmode) fluxvalid = false;
+        dbmode = enable;
+    }
+    float readDB(unsigned int binNumber) {
+        if (binNumber > 511) return -96.0;
+        if (dbmode) return (float)(output[binNumber]) * (1.0 / 256.0) + dboffset;
+        float v = read(binNumber);
+        return v > 0.0f ? 20.0f * log10f(v) : -96.0f;
     }
     void averageTogether(uint8_t n) {
         // not implemented yet (may never be, 86 Hz output rate is ok)
     }
-    void windowFunction(const int16_t *w) {
+    // calibrate divides read() by the window's coherent gain, so a sine
+    // centered on a bin reads its amplitude, 1.0 = full scale
+    void windowFunction(const int16_t *w, bool calibrate = false) {
+        __disable_irq();
         window = w;
+        windowhalf = false;
+        __enable_irq();
+        calibration(calibrate);
+    }
+    // symmetric window stored as its first 512 values, half the size of a
+    // full table, the second half of each frame reads it backwards
+    void windowSymmetric(const int16_t *half, bool calibrate = false) {
+        __disable_irq();
+        window = half;
+        windowhalf = half != NULL;
+        __enable_irq();
+        calibration(calibrate);
+    }
+    // Where the frame available() reported came from, set together with
+    // output[] so it stays valid until the next frame. frameSample() is
+    // the first sample of its window, counted from the analyzer's first
+    // update at 128 per update, including updates that had no block, so
+    // it lines up with other objects in the same audio stream. frameHop()
+    // numbers the frame positions, a frame dropped by overruns() or load
+    // shedding still takes one, so a step of more than one means frames
+    // were missed. Zoom hops are 8 * factor blocks, sliding hops 1.
+    uint64_t frameSample(void) {
+        return framesample;
+    }
+    uint32_t frameHop(void) {
+        return framehop;
+    }
+    // the window was not 1024 consecutive samples, updates without a
+    // block fell inside it or the sliding history is still filling
+    bool frameGap(void) {
+        return framegap;
+    }
+    // The scaling output[] had: read() units per step (the fixed point
+    // fft's 1/1024 and any window calibration included), Q8 dB when
+    // frameDB() is true, and the shed level, FFT_SHED_CHEAP values are
+    // estimates.
+    float frameScale(void) {
+        return framescale;
+    }
+    bool frameDB(void) {
+        return framedb;
+    }
+    uint8_t frameShed(void) {
+        return frameshed;
+    }
+    // one of the FFT_SCHEDULE_ policies above, useYield runs the worker of
+    // HYBRID and DEFERRED from yield() rather than a software interrupt
+    void schedule(uint8_t policy, bool useYield = false);
+    // frames dropped because the worker was still busy
+    uint32_t overruns(void) {
+        return overruncount;
+    }
+    // Cycle budget for one update() of the fft, 0 turns the check off.
+    // Each update over budget is counted and raises the shed level by
+    // one, up to maxShed, so the analyzer first drops the frame that ran
+    // over and then lowers its frame rate and cost until updates fit.
+    // After FFT_SHED_RECOVER hops with a quarter of the budget to spare
+    // it steps back one level. The zoom, sparse and sliding modes are
+    // checked against the budget and counted by overBudget(), but never
+    // shed. Also clears the counters below.
+    void budget(uint32_t cycles, uint8_t maxShed = FFT_SHED_CHEAP);
+    // most cycles an update took in each of the 8 states, with or without
+    // a budget, to pick one, FFT_SLOT_MODE for the other modes
+    uint32_t slotCycles(uint8_t slot) {
+        return slot <= FFT_SLOT_MODE ? slotcycles[slot] : 0;
+    }
+    uint32_t overBudget(void) {
+        return overbudgetcount;
+    }
+    // frames dropped or not computed by the SKIP and HOP levels
+    uint32_t framesShed(void) {
+        return shedframecount;
+    }
+    // times the shed level went up
+    uint32_t degradations(void) {
+        return degradecount;
+    }
+    uint8_t shedLevel(void) {
+        return shedlevel;
+    }
+    // FFT_KERNEL_RADIX8 runs the middle stage as two radix-8 passes
+    // instead of three radix-4 passes, one pass less over the buffer.
+    // The bins match the radix-4 kernel within rounding.
+    void kernel(uint8_t k);
+    // The packed twiddles of both kernels are const tables in flash. This
+    // copies them into buffer, FFT_TWIDDLE_RAM_WORDS long, for all
+    // analyzers to read from RAM, NULL goes back to flash. Call it before
+    // the audio starts or once it no longer reads the buffer.
+    static void twiddlesInRAM(int32_t *buffer);
+    // Bands are summed inside the magnitude loop, so reading them costs
+    // nothing extra. edges[] holds count+1 bin numbers, band n covers bins
+    // edges[n] to edges[n+1]-1. weights[] are Q15 gains per band, NULL sums
+    // the bins like read(binFirst, binLast) does. With bandsOnly the 512
+    // bin output[] array is no longer written. Returns the bands set up,
+    // edges that don't climb or pass 512 end the map early.
+    uint8_t bandMap(const uint16_t *edges, uint8_t count, const uint16_t *weights = NULL, bool bandsOnly = false);
+    // log (octave) or mel spaced bands from freqLow to freqHigh Hz,
+    // average = true divides each band by the number of bins it covers.
+    // An edge above Nyquist is moved down to bin 512, and bands narrower
+    // than a bin are widened, so the top bands can run out of bins. The
+    // count actually set up is returned, and bands() gives it later.
+    uint8_t bandMapLog(uint8_t count, float freqLow, float freqHigh, bool average = false, bool bandsOnly = false);
+    uint8_t bandMapMel(uint8_t count, float freqLow, float freqHigh, bool average = false, bool bandsOnly = false);
+    uint8_t bands(void) {
+        return bandcount;
+    }
+    float readBand(unsigned int band) {
+        if (band >= bandcount) return 0.0;
+        return (float)(bandoutput[band]) * readscale;
+    }
+    // Zoom mode mixes centerFreq down to 0 Hz, decimates by factor (2 to
+    // 128, rounded down to a power of two) and runs the same staged fft on
+    // the complex result. output[] then covers centerFreq +/- a quarter of
+    // the decimated sample rate, bin 256 sits on centerFreq, and the bins are
+    // factor times narrower. A new frame is ready every 8*factor blocks.
+    // factor < 2 returns to the normal 512 bin analysis.
+    void zoom(float centerFreq, uint8_t factor);
+    float binFrequency(float binNumber) {
+        if (mode == FFT_MODE_ZOOM) {
+            return zoomcenter + (binNumber - 256.0f) * (AUDIO_SAMPLE_RATE_EXACT / 1024.0f) / zoomfactor;
+        }
+        return binNumber * (AUDIO_SAMPLE_RATE_EXACT / 1024.0f);
+    }
+    // Peak search after the magnitude loop: the strongest count (up to 8)
+    // local maxima above threshold, in read() units or dB with outputDB(),
+    // refined to a fraction of a bin with parabolic interpolation. The
+    // threshold is converted for each frame, so a later outputDB() or
+    // window calibration doesn't change the level it stands for. The
+    // list is sorted strongest first and published with available(). The
+    // flat schedule runs it in case 6, the others right after the
+    // magnitudes. It searches output[], so with bandsOnly set no peaks
+    // are found unless features() keeps output[] written. count = 0
+    // turns it off.
+    void peaks(uint8_t count, float threshold = 0.0);
+    uint8_t peakCount(void) {
+        return peakcount;
+    }
+    float peakBin(unsigned int n) {
+        if (n >= peakcount) return 0.0;
+        return peakpos[n] * (1.0f / 256.0f);
+    }
+    float peakFrequency(unsigned int n) {
+        if (n >= peakcount) return 0.0;
+        return binFrequency(peakpos[n] * (1.0f / 256.0f));
+    }
+    float peakAmplitude(unsigned int n) {
+        if (n >= peakcount) return 0.0;
+        if (framedb) return peakval[n] * (1.0f / 256.0f) + dboffset;
+        return peakval[n] * framescale;
+    }
+    // Spectral features summed inside the magnitude loop and published
+    // with available(): centroid (magnitude weighted mean frequency, Hz),
+    // flatness (geometric over arithmetic mean of the power, 0 to 1), flux
+    // (sum of the bins' rises since the last frame, in read() units or dB)
+    // and rolloff (frequency below which rolloffFraction of the power
+    // lies). The flat schedule finishes the rolloff in case 6. Flux is
+    // taken against the last frame in output[], so output[] is written
+    // while features are on, with bandsOnly too. It reads 0 for the first
+    // frame after features(), outputDB(), zoom(), sparseBins() or
+    // slidingBins() change what output[] holds, and after a shed level
+    // change.
+    void features(bool enable, float rolloffFraction = 0.85);
+    float centroid(void) {
+        if (featmag == 0) return 0.0;
+        return binFrequency((float)featmagk / (float)featmag);
+    }
+    float flatness(void);
+    float flux(void) {
+        if (framedb) return featflux * (1.0f / 256.0f);
+        return featflux * framescale;
+    }
+    float rolloff(void) {
+        return binFrequency((float)featrolloff);
     }
+    // When only a few bins are needed, sparseBins() swaps the fft for one
+    // Goertzel filter per bin. Each block costs count * 128 filter steps
+    // and a frame of the registered bins is ready every 8 blocks through
+    // the usual available() and read(). count = 0 returns to the fft.
+    void sparseBins(const uint16_t *bins, uint8_t count);
+    // Sliding dft: the registered bins are updated on every block from the
+    // last 1024 samples, so available() is true every update with one block
+    // of latency. hann applies a Hann window in the frequency domain from
+    // the neighbouring bins. count = 0 returns to the fft.
+    void slidingBins(const uint16_t *bins, uint8_t count, bool hann = true);
     virtual void update(void);
     int16_t output[512] __attribute__ ((aligned (4)));
+    uint32_t bandoutput[FFT_MAX_BANDS];
 private:
-    void init(void);
+    void calibration(bool calibrate);
+    void magnitudes(const int16_t *buf, int offset);
+    void estimateMagnitudes(const int16_t *buf, int offset);
+    void checkBudget(uint8_t slot, uint32_t cycles);
+    void releaseBlocks(void);
+    void zoomUpdate(audio_block_t *block, uint64_t now);
+    void zoomMix(const int16_t *data, uint64_t number);
+    void goertzelUpdate(audio_block_t *block, uint64_t now);
+    void slidingUpdate(audio_block_t *block, uint64_t now);
+    void latchFrame(uint64_t first, bool gap);
+    void stampFrame(void);
+    static void workerEvent(EventResponderRef event);
+    void workerStep(void);
+    void stage2(int16_t *buf);
+    void publish(bool defer);
+    void findPeaks(void);
+    void featureMagnitudes(const int16_t *buf, int offset);
+    void findRolloff(void);
+    uint8_t bandMapFreq(const float *freq, uint8_t count, bool average, bool bandsOnly);
     const int16_t *window;
+    bool windowhalf;
+    float readscale, dboffset;
+    bool dbmode;
     audio_block_t *blocklist[8];
     int16_t buffer[2048] __attribute__ ((aligned (4)));
     uint8_t state;
-    volatile bool outputflag, firstrun;
+    volatile bool outputflag;
+    bool primed;
+    volatile uint8_t workerstep;
+    uint8_t mode, policy, fftkernel;
+    bool workeryield;
+    volatile uint32_t overruncount;
+    // load shedding
+    uint32_t cyclebudget;
+    uint32_t slotcycles[FFT_SLOT_MODE + 1];
+    volatile uint32_t overbudgetcount, shedframecount, degradecount;
+    uint8_t shedmax, shedlevel, calmcount;
+    bool hopskip, lastshed;
+    // frame timestamps: the update each held block arrived in, the frame
+    // in the buffer and the one last published
+    uint64_t updates, slotblock[8];
+    uint32_t hopcount;
+    uint64_t pendingsample;
+    uint32_t pendinghop;
+    bool pendinggap;
+    uint64_t framesample;
+    uint32_t framehop;
+    bool framegap;
+    float framescale;
+    bool framedb;
+    uint8_t frameshed;
+    EventResponder worker;
     audio_block_t *inputQueueArray[1];
     arm_cfft_radix4_instance_q15 fft_inst;
+    uint16_t bandedge[FFT_MAX_BANDS+1];
+    uint16_t bandweight[FFT_MAX_BANDS];
+    uint8_t bandcount;
+    bool bandsonly;
+    // peak search
+    uint32_t peakpos[FFT_MAX_PEAKS];
+    int32_t peakval[FFT_MAX_PEAKS];
+    float peakthreshold, peakthresholddb;
+    uint8_t peakmax, peakcount;
+    bool postpending;
+    // spectral features
+    uint64_t featmagk, featpow;
+    uint32_t featmag, featflux;
+    int32_t featdb;
+    uint32_t featchunk[32];
+    uint16_t featrolloff, rollofffrac;
+    int16_t featoffset;
+    bool featureson, fluxvalid;
+    // zoom mode
+    float zoomcenter;
+    uint32_t zoomphase, zoomphaseinc;
+    int32_t zoomre, zoomim;
+    uint16_t zoomfill;
+    uint8_t zoomfactor, zoomshift, zoomcount;
+    uint8_t zoomstate, zoompending;
+    uint64_t zoomstart, zoomlast;
+    bool zoomgap;
+    // sparse (Goertzel) mode
+    uint16_t sparsebin[FFT_MAX_SPARSE_BINS];
+    int32_t sparsecos[FFT_MAX_SPARSE_BINS], sparsesin[FFT_MAX_SPARSE_BINS];
+    int32_t sparses1[FFT_MAX_SPARSE_BINS], sparses2[FFT_MAX_SPARSE_BINS];
+    uint16_t sparsepos;
+    uint8_t sparsecount;
+    // sliding dft mode, each registered bin uses the trackers for bin-1,
+    // bin and bin+1, shared between neighbours
+    uint16_t slidebin[FFT_MAX_SLIDING_BINS];
+    uint8_t slidetap[FFT_MAX_SLIDING_BINS][3];
+    uint16_t slidek[3*FFT_MAX_SLIDING_BINS];
+    int64_t slidere[3*FFT_MAX_SLIDING_BINS], slideim[3*FFT_MAX_SLIDING_BINS];
+    uint16_t slidepos;
+    uint8_t slidecount, slidetracks;
+    bool slidehann;
 };
 
 #endif
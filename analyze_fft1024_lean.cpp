@@ -0,0 +1,199 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "analyze_fft1024_lean.h"
+#include "utility/sqrt_integer.h"
+#include "utility/dspinst.h"
+
+// the generic staged fft, run here at 256 points
+extern "C" {
+    void arm_cfft_radix4_q15_stage1(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+}
+
+// fft arena shared by every instance started with beginShared(), each one
+// only uses it inside its own update()
+static int16_t fft_arena[1024] __attribute__ ((aligned (4)));
+static uint8_t fft_arena_phase = 0;
+
+// Windows 2 * pairs real samples into the fft buffer. Consecutive samples
+// become the real and imaginary part of one complex value, so the packing
+// costs nothing. Samples are halved on the way in, which leaves the radix-2
+// pass room for its twiddle rotation.
+static void window_pairs(uint32_t *dst, const uint32_t *src, const uint32_t *win, int pairs)
+{
+    if (!win) {
+        for (int i=0; i < pairs; i++) {
+            *dst++ = __SHADD16(*src++, 0);
+        }
+        return;
+    }
+    for (int i=0; i < pairs; i++) {
+        uint32_t s = *src++;
+        uint32_t w = *win++;
+        int32_t re = multiply_16bx16b(s, w) >> 16;
+        int32_t im = multiply_16tx16t(s, w) >> 16;
+        *dst++ = pack_16b_16b(im, re);
+    }
+}
+
+// First radix-2 decimation in frequency pass of the 512 point fft, the
+// sum goes to the first half, the difference times W512^n to the second.
+// The two halves are then 256 point ffts, giving the even and the odd
+// bins. Both halves are scaled by 1/2.
+static void radix2_pass(uint32_t *z, const q15_t *tw, uint32_t stride)
+{
+    for (int n=0; n < 256; n++) {
+        uint32_t p = z[n], q = z[n + 256];
+        uint32_t c = *(const uint32_t *)(tw + 2 * stride * n);
+        uint32_t d = __SHSUB16(p, q);
+        z[n] = __SHADD16(p, q);
+        z[n + 256] = pack_16b_16b(__SMUSDX(c, d) >> 15, __SMUAD(c, d) >> 15);
+    }
+}
+
+uint32_t AudioAnalyzeFFT1024_Lean::bytesSaved(void)
+{
+    // AudioAnalyzeFFT1024_Fast: 4 KB buffer, 1 KB output, 8 blocks held
+    const uint32_t fast = 2048 * 2 + 512 * 2 + 8 * sizeof(audio_block_t);
+    uint32_t lean = sizeof(overlap) + 4 * sizeof(audio_block_t);
+    if (out) lean += 512 * 2;         // own output, shared scratch
+    else lean += 1024 * 2;            // own scratch holding the output
+    return fast - lean;
+}
+
+void AudioAnalyzeFFT1024_Lean::begin(int16_t *scratchBuffer, int16_t *outputBuffer)
+{
+    __disable_irq();
+    scratch = scratchBuffer;
+    out = outputBuffer;
+    outputflag = false;
+    __enable_irq();
+}
+
+// The first hop after beginShared() is shortened to phase blocks, from
+// then on this instance's frames run in that block of every hop.
+void AudioAnalyzeFFT1024_Lean::beginShared(int16_t *outputBuffer, int phase)
+{
+    if (phase < 0) phase = fft_arena_phase++ & 3;
+    __disable_irq();
+    scratch = fft_arena;
+    out = outputBuffer;
+    outputflag = false;
+    hopphase = phase & 3;
+    hoplen = hopphase ? hopphase : 4;
+    __enable_irq();
+}
+
+// One frame: window, radix-2 pass, the two 256 point ffts and the real
+// split. With Z the 512 point fft of the packed samples, bins k and 512-k
+// come from the same pair Z[k], Z[512-k]:
+//   A = Z[k] + conj(Z[512-k]), B = Z[k] - conj(Z[512-k])
+//   X[k] = (A - j W^k B) / 2, X[512-k] = (conj(A) - j conj(W^k) conj(B)) / 2
+// with W = exp(-2 pi j / 1024). The two results are written back over the
+// pair's own slots, so the output can live in the fft buffer.
+void AudioAnalyzeFFT1024_Lean::frame(void)
+{
+    uint32_t *z = (uint32_t *)scratch;
+    const uint32_t *win = (const uint32_t *)window;
+    const q15_t *tw = fft_inst.pTwiddle;
+    // the instance table step is W256, W512 is half and W1024 a quarter
+    const uint32_t stride = fft_inst.twidCoefModifier / 2;
+    
+    window_pairs(z, (const uint32_t *)overlap, win, 256);
+    for (int i=0; i < 4; i++) {
+        window_pairs(z + 256 + i * 64, (const uint32_t *)blocklist[i]->data, win ? win + 256 + i * 64 : NULL, 64);
+    }
+    radix2_pass(z, tw, stride);
+    arm_cfft_radix4_q15_stage1(&fft_inst, scratch);
+    arm_cfft_radix4_q15_stage2(&fft_inst, scratch);
+    arm_cfft_radix4_q15_stage3(&fft_inst, scratch);
+    arm_cfft_radix4_q15_stage1(&fft_inst, scratch + 512);
+    arm_cfft_radix4_q15_stage2(&fft_inst, scratch + 512);
+    arm_cfft_radix4_q15_stage3(&fft_inst, scratch + 512);
+    
+    // Z[k] is at the 9 bit reversed slot
+    for (int k=0; k <= 256; k++) {
+        const int m = (512 - k) & 511;
+        const int sk = __RBIT(k) >> 23, sm = __RBIT(m) >> 23;
+        const uint32_t zk = z[sk], zm = z[sm];
+        const int32_t ar = ((int16_t)zk + (int16_t)zm) >> 1;
+        const int32_t ai = (((int32_t)zk >> 16) - ((int32_t)zm >> 16)) >> 1;
+        const int32_t br = ((int16_t)zk - (int16_t)zm) >> 1;
+        const int32_t bi = (((int32_t)zk >> 16) + ((int32_t)zm >> 16)) >> 1;
+        const uint32_t c = *(const uint32_t *)(tw + stride * k);
+        const uint32_t b = pack_16b_16b(bi, br);
+        const int32_t p = __SMUSDX(c, b) >> 15;     // cos * bi - sin * br
+        const int32_t q = __SMUAD(c, b) >> 15;      // cos * br + sin * bi
+        int32_t re = __SSAT(ar + p, 16), im = __SSAT(ai - q, 16);
+        const int16_t magk = sqrt_uint32_approx((uint32_t)(re * re) + (uint32_t)(im * im));
+        if (k > 0 && k < 256) {
+            re = __SSAT(ar - p, 16);
+            im = __SSAT(ai + q, 16);
+            const int16_t magm = sqrt_uint32_approx((uint32_t)(re * re) + (uint32_t)(im * im));
+            if (out) out[m] = magm;
+            else scratch[2 * sm] = magm;
+        }
+        if (out) out[k] = magk;
+        else scratch[2 * sk] = magk;
+    }
+}
+
+void AudioAnalyzeFFT1024_Lean::update(void)
+{
+    audio_block_t *block;
+    
+    block = receiveReadOnly();
+    if (!block) return;
+    
+#if defined(KINETISK)
+    if (!scratch) {
+        release(block);
+        return;
+    }
+    blocklist[state++] = block;
+    if (state < hoplen) return;
+    const int n = state;
+    if (n == 4) {
+        frame();
+        outputflag = true;
+    }
+    // the newest 512 samples become the overlap of the next frame, a short
+    // hop that only sets up the phase shifts the overlap along
+    if (n < 4) {
+        memmove(overlap, overlap + n * AUDIO_BLOCK_SAMPLES, (4 - n) * sizeof(blocklist[0]->data));
+    }
+    for (int i=0; i < n; i++) {
+        memcpy(overlap + (4 - n + i) * AUDIO_BLOCK_SAMPLES, blocklist[i]->data, sizeof(blocklist[i]->data));
+        release(blocklist[i]);
+    }
+    state = 0;
+    hoplen = 4;
+#else
+    release(block);
+#endif
+}
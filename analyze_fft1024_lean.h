@@ -0,0 +1,117 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef AudioAnalyzeFFT1024_Lean_h_
+#define AudioAnalyzeFFT1024_Lean_h_
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "arm_math.h"
+#include "analyze_fft1024_fast.h"
+
+// Memory lean 1024 point analyzer with the same 512 bins and scaling as
+// AudioAnalyzeFFT1024_Fast. The 1024 real samples are packed in place as
+// 512 complex pairs, so the fft buffer is 2 KB instead of 4 KB, and the
+// 512 point fft is split back into the real spectrum. Only the older half
+// of each frame is kept, as 16 bit samples, so 4 audio blocks are held
+// instead of 8. The whole frame runs in the update of every 4th block.
+//
+// The fft buffer is supplied with begin(). With scratch alone the
+// magnitudes are left inside it and read() finds them there, they stay
+// valid until the next frame 4 updates later. With an out array as well
+// the magnitudes go there and scratch is only touched inside update(), so
+// any number of analyzers can share one scratch buffer. beginShared() does
+// that with the library's own fft arena and also staggers the instances
+// over the 4 blocks of the hop, so their frames don't all land in the same
+// update.
+class AudioAnalyzeFFT1024_Lean : public AudioStream
+{
+public:
+    AudioAnalyzeFFT1024_Lean() : AudioStream(1, inputQueueArray),
+    window(AudioWindowHanning1024), scratch(NULL), out(NULL), state(0), hoplen(4), hopphase(0), outputflag(false) {
+        memset(overlap, 0, sizeof(overlap));
+        arm_cfft_radix4_init_q15(&fft_inst, 256, 0, 0);
+    }
+    // scratch holds 1024 int16, out 512 int16, both 4 byte aligned
+    void begin(int16_t *scratchBuffer, int16_t *outputBuffer = NULL);
+    // shared arena, out holds 512 int16. phase 0 to 3 picks the block of
+    // the hop the frame runs in, -1 hands them out in turn
+    void beginShared(int16_t *outputBuffer, int phase = -1);
+    uint8_t phase(void) {
+        return hopphase;
+    }
+    bool available() {
+        if (outputflag == true) {
+            outputflag = false;
+            return true;
+        }
+        return false;
+    }
+    float read(unsigned int binNumber) {
+        if (binNumber > 511) return 0.0;
+        return (float)bin(binNumber) * (1.0 / 16384.0);
+    }
+    float read(unsigned int binFirst, unsigned int binLast) {
+        if (binFirst > binLast) {
+            unsigned int tmp = binLast;
+            binLast = binFirst;
+            binFirst = tmp;
+        }
+        if (binFirst > 511) return 0.0;
+        if (binLast > 511) binLast = 511;
+        uint32_t sum = 0;
+        do {
+            sum += bin(binFirst++);
+        } while (binFirst <= binLast);
+        return (float)sum * (1.0 / 16384.0);
+    }
+    void windowFunction(const int16_t *w) {
+        window = w;
+    }
+    // bytes of RAM and audio memory saved against AudioAnalyzeFFT1024_Fast,
+    // a shared scratch buffer is not counted as this instance's
+    uint32_t bytesSaved(void);
+    virtual void update(void);
+private:
+    // bin k of the aliased output sits in the low half of the fft slot it
+    // was computed from, the 9 bit reversed index
+    int16_t bin(unsigned int k) {
+        if (out) return out[k];
+        if (!scratch) return 0;
+        return scratch[2 * (__RBIT(k) >> 23)];
+    }
+    void frame(void);
+    const int16_t *window;
+    int16_t *scratch, *out;
+    audio_block_t *blocklist[4];
+    int16_t overlap[512] __attribute__ ((aligned (4)));
+    uint8_t state, hoplen, hopphase;
+    volatile bool outputflag;
+    audio_block_t *inputQueueArray[1];
+    arm_cfft_radix4_instance_q15 fft_inst;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include <Audio.h>
+#include <Wire.h>
+#include <SPI.h>
+#include <SD.h>
+#include <SerialFlash.h>
+#include <analyze_fft1024_fast.h>
+
+// Times each stage of the 1024 point fft, radix-4 and radix-8 middle
+// stage side by side, with the cpu cycle counter, reading the twiddles
+// from flash and then from RAM.
+
+extern "C" {
+    void arm_cfft_radix4_q15_1024_stage1(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix8_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+}
+
+arm_cfft_radix4_instance_q15 fft_inst;
+int16_t buffer[2048] __attribute__ ((aligned (4)));
+int32_t twiddles[FFT_TWIDDLE_RAM_WORDS];
+
+void fill() {
+    for (int i = 0; i < 2048; i += 2) {
+        buffer[i] = random(-16384, 16384);
+        buffer[i+1] = 0;
+    }
+}
+
+void run(bool radix8, bool ram) {
+    uint32_t t0, t1, t2, t3;
+    fill();
+    __disable_irq();
+    t0 = ARM_DWT_CYCCNT;
+    arm_cfft_radix4_q15_1024_stage1(&fft_inst, buffer);
+    t1 = ARM_DWT_CYCCNT;
+    if (radix8) arm_cfft_radix8_q15_1024_stage2(&fft_inst, buffer);
+    else arm_cfft_radix4_q15_1024_stage2(&fft_inst, buffer);
+    t2 = ARM_DWT_CYCCNT;
+    arm_cfft_radix4_q15_1024_stage3(&fft_inst, buffer);
+    t3 = ARM_DWT_CYCCNT;
+    __enable_irq();
+    Serial.printf("%s %s  stage1: %6lu  stage2: %6lu  stage3: %6lu  total: %6lu cycles\n",
+                  radix8 ? "radix-8" : "radix-4", ram ? "ram  " : "flash", t1 - t0, t2 - t1, t3 - t2, t3 - t0);
+}
+
+void setup() {
+    while (!Serial);
+    delay(100);
+    Serial.println("Fast FFT Stage Benchmark...");
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+    arm_cfft_radix4_init_q15(&fft_inst, 1024, 0, 0);
+}
+
+void loop() {
+    AudioAnalyzeFFT1024_Fast::twiddlesInRAM(NULL);
+    run(false, false);
+    run(true, false);
+    AudioAnalyzeFFT1024_Fast::twiddlesInRAM(twiddles);
+    run(false, true);
+    run(true, true);
+    delay(1000);
+}
@@ -0,0 +1,33 @@
+#include <Audio.h>
+#include <Wire.h>
+#include <SPI.h>
+#include <SD.h>
+#include <SerialFlash.h>
+#include <analyze_fft1024_fast.h>
+#include <fft_stream.h>
+
+// Sends every frame as a delta coded binary packet, read them on the
+// computer with extras/host/spectrum_decode.
+AudioAnalyzeFFT1024_Fast  fastfft;
+AudioSynthWaveformSine    sinewave;
+AudioOutputAnalog         dac;
+FFTStream                 stream;
+
+AudioConnection patchCord1(sinewave, 0, fastfft, 0);
+AudioConnection patchCord2(sinewave, 0, dac, 0);
+
+void setup() {
+    while (!Serial);
+    delay(100);
+    AudioMemory(24);
+    fastfft.windowFunction(AudioWindowHanning1024);
+    sinewave.amplitude(0.8);
+    sinewave.frequency(440);
+    stream.begin(Serial, FFT_STREAM_DELTA, 32);
+}
+
+void loop() {
+    if (fastfft.available()) stream.write(fastfft);
+    // sends what the port takes without waiting, the rest next loop()
+    stream.update();
+}
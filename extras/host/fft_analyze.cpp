@@ -0,0 +1,331 @@
+// Offline spectrogram tool. Runs WAV or raw 16 bit PCM files through the
+// same AudioAnalyzeFFT1024_Fast update() pipeline, fft.c stages and tables
+// as the device, one AUDIO_BLOCK_SAMPLES block per update(), and writes
+// every published frame to a binary spectrogram, see spectrogram.h.
+// Files are memory mapped and spread over worker threads, one analyzer
+// per file.
+
+#include "analyze_fft1024_fast.h"
+#include "spectrogram.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct options {
+    const int16_t *window;
+    bool windowhalf, calibrate, db, radix8, raw;
+    uint8_t bands;
+    float bandlow, bandhigh;
+    uint32_t rawrate;
+    unsigned channel, jobs;
+    const char *outdir;
+};
+
+struct source {
+    const uint8_t *map;
+    size_t mapsize;
+    const int16_t *samples;     // first sample of the selected channel
+    size_t frames;              // samples per channel
+    unsigned stride;            // int16_t between samples of one channel
+    uint32_t rate;
+};
+
+static const struct {
+    const char *name;
+    const int16_t *table;
+} windows[] = {
+    { "hanning", AudioWindowHanning1024 },
+    { "bartlett", AudioWindowBartlett1024 },
+    { "blackman", AudioWindowBlackman1024 },
+    { "flattop", AudioWindowFlattop1024 },
+    { "blackmanharris", AudioWindowBlackmanHarris1024 },
+    { "nuttall", AudioWindowNuttall1024 },
+    { "blackmannuttall", AudioWindowBlackmanNuttall1024 },
+    { "welch", AudioWindowWelch1024 },
+    { "hamming", AudioWindowHamming1024 },
+    { "cosine", AudioWindowCosine1024 },
+    { "tukey", AudioWindowTukey1024 },
+};
+
+static int16_t generated[512] __attribute__ ((aligned (4)));
+
+static void usage(void)
+{
+    fprintf(stderr,
+        "usage: fft_analyze [options] file...\n"
+        "  -o dir      write the spectrograms here, default next to each file\n"
+        "  -j jobs     files analyzed in parallel, default one per core\n"
+        "  -w window   hanning (default), hamming, blackman, flattop, ..., none,\n"
+        "              kaiser:beta, gaussian:sigma or tukey:alpha\n"
+        "  -C          calibrate read() units to the window gain\n"
+        "  -d          Q8 dB output\n"
+        "  -b count    count log bands (bands only), see -f\n"
+        "  -f low:high band range in Hz, default 40:16000\n"
+        "  -k          radix-8 middle stage\n"
+        "  -r rate     raw input, 16 bit little endian mono at rate Hz\n"
+        "  -c channel  channel of a multichannel wav, default 0\n");
+    exit(2);
+}
+
+static bool parse_window(const char *arg, options *opt)
+{
+    opt->windowhalf = false;
+    if (strcmp(arg, "none") == 0) {
+        opt->window = NULL;
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        if (strcmp(arg, windows[i].name) == 0) {
+            opt->window = windows[i].table;
+            return true;
+        }
+    }
+    const char *colon = strchr(arg, ':');
+    if (!colon) return false;
+    const float param = strtof(colon + 1, NULL);
+    const std::string name(arg, colon - arg);
+    if (name == "kaiser") generateWindowKaiser(generated, 1024, param);
+    else if (name == "gaussian") generateWindowGaussian(generated, 1024, param);
+    else if (name == "tukey") generateWindowTukey(generated, 1024, param);
+    else return false;
+    opt->window = generated;
+    opt->windowhalf = true;
+    return true;
+}
+
+static void configure(AudioAnalyzeFFT1024_Fast *fft, const options &opt)
+{
+    if (opt.windowhalf) fft->windowSymmetric(opt.window, opt.calibrate);
+    else fft->windowFunction(opt.window, opt.calibrate);
+    if (opt.radix8) fft->kernel(FFT_KERNEL_RADIX8);
+    if (opt.bands) fft->bandMapLog(opt.bands, opt.bandlow, opt.bandhigh, false, true);
+    fft->outputDB(opt.db);
+}
+
+static uint16_t read16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t read32(const uint8_t *p) { return read16(p) | ((uint32_t)read16(p + 2) << 16); }
+
+// walks the RIFF chunks for fmt and data, 16 bit PCM only
+static const char * parse_wav(source *src, unsigned channel)
+{
+    const uint8_t *p = src->map, *end = src->map + src->mapsize;
+    if (src->mapsize < 12 || memcmp(p, "RIFF", 4) || memcmp(p + 8, "WAVE", 4)) {
+        return "not a wav file, use -r for raw pcm";
+    }
+    unsigned channels = 0;
+    p += 12;
+    while (end - p >= 8) {
+        const uint32_t size = read32(p + 4);
+        const uint8_t *body = p + 8;
+        if (size > (size_t)(end - body)) return "truncated chunk";
+        if (memcmp(p, "fmt ", 4) == 0 && size >= 16) {
+            const uint16_t format = read16(body);
+            if ((format != 1 && format != 0xFFFE) || read16(body + 14) != 16) {
+                return "only 16 bit pcm is supported";
+            }
+            channels = read16(body + 2);
+            src->rate = read32(body + 4);
+        } else if (memcmp(p, "data", 4) == 0) {
+            if (channels == 0) return "data before fmt chunk";
+            if (channel >= channels) return "no such channel";
+            if ((uintptr_t)body & 1) return "misaligned data chunk";
+            src->samples = (const int16_t *)body + channel;
+            src->stride = channels;
+            src->frames = size / (2 * channels);
+            return NULL;
+        }
+        p = body + size + (size & 1);
+    }
+    return "no data chunk";
+}
+
+static std::string output_path(const char *input, const options &opt)
+{
+    std::string path(input);
+    const size_t dot = path.find_last_of('.'), slash = path.find_last_of('/');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) path.resize(dot);
+    path += ".spg";
+    if (opt.outdir) {
+        const size_t base = path.find_last_of('/');
+        path = std::string(opt.outdir) + "/" + (base == std::string::npos ? path : path.substr(base + 1));
+    }
+    return path;
+}
+
+// Streams one mapped file through a fresh analyzer. The last block is
+// padded with zeros to a whole hop, then silent blocks flush the frame
+// still in flight in the flat schedule. Sets the header's band count and
+// frame count.
+static const char * analyze(const source &src, FILE *out, const options &opt, spectrogram_header *h)
+{
+    AudioAnalyzeFFT1024_Fast *fft = new AudioAnalyzeFFT1024_Fast();
+    configure(fft, opt);
+    // the band map can set up fewer bands than -b asked for, the header is
+    // written again once the file is done
+    if (opt.bands) {
+        h->bins = fft->bands();
+        if (h->bins == 0) {
+            delete fft;
+            return "no bands in the -f range";
+        }
+    }
+
+    const size_t hops = (src.frames + h->hop - 1) / h->hop;
+    const size_t expected = hops > 1 ? hops - 1 : 0;
+    const size_t bytes = spectrogram_frame_bytes(h);
+    const void *frame = opt.bands ? (const void *)fft->bandoutput : (const void *)fft->output;
+    const char *err = NULL;
+    size_t pos = 0, published = 0;
+
+    while (published < expected) {
+        audio_block_t *block = AudioStream::allocate();
+        if (!block) {
+            err = "out of memory";
+            break;
+        }
+        const int16_t *s = src.samples + pos * src.stride;
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++, pos++) {
+            block->data[i] = pos < src.frames ? *s : 0;
+            s += src.stride;
+        }
+        // update() owns the block from here, like a received block
+        fft->hostInject(block);
+        fft->update();
+        if (fft->available()) {
+            if (fwrite(frame, bytes, 1, out) != 1) {
+                err = strerror(errno);
+                break;
+            }
+            published++;
+        }
+    }
+    h->frames = published;
+    delete fft;
+    return err;
+}
+
+static bool process(const char *input, const options &opt)
+{
+    source src = source();
+    const char *err = NULL;
+    FILE *out = NULL;
+    std::string path;
+    spectrogram_header h = spectrogram_header();
+
+    int fd = open(input, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "%s: %s\n", input, strerror(errno));
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    src.mapsize = st.st_size;
+    if (src.mapsize == 0) {
+        err = "empty file";
+        goto done;
+    }
+    src.map = (const uint8_t *)mmap(NULL, src.mapsize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (src.map == MAP_FAILED) {
+        src.map = NULL;
+        err = strerror(errno);
+        goto done;
+    }
+    madvise((void *)src.map, src.mapsize, MADV_SEQUENTIAL);
+    if (opt.raw) {
+        src.samples = (const int16_t *)src.map;
+        src.frames = src.mapsize / 2;
+        src.stride = 1;
+        src.rate = opt.rawrate;
+    } else if ((err = parse_wav(&src, opt.channel)) != NULL) {
+        goto done;
+    }
+
+    h.magic = SPECTROGRAM_MAGIC;
+    h.version = SPECTROGRAM_VERSION;
+    h.flags = (opt.db ? SPECTROGRAM_DB : 0) | (opt.bands ? SPECTROGRAM_BANDS : 0) | (opt.radix8 ? SPECTROGRAM_RADIX8 : 0);
+    h.bins = opt.bands ? opt.bands : 512;
+    h.hop = 512;
+    h.sampleRate = src.rate;
+    h.scale = 1.0f / 16384.0f;
+    if (opt.calibrate) h.scale /= windowGain(opt.window, 1024, opt.windowhalf);
+    h.dbOffset = 20.0f * log10f(h.scale * 16384.0f);
+
+    path = output_path(input, opt);
+    out = fopen(path.c_str(), "wb");
+    if (!out) {
+        err = strerror(errno);
+        goto done;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    // the frame count is filled in once the file is done
+    if (fwrite(&h, sizeof(h), 1, out) != 1) {
+        err = strerror(errno);
+        goto done;
+    }
+    err = analyze(src, out, opt, &h);
+    if (!err && (fseek(out, 0, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, out) != 1)) {
+        err = strerror(errno);
+    }
+done:
+    if (out && fclose(out) != 0 && !err) err = strerror(errno);
+    if (src.map) munmap((void *)src.map, src.mapsize);
+    close(fd);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", input, err);
+        return false;
+    }
+    printf("%s: %u frames -> %s\n", input, h.frames, path.c_str());
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    options opt = options();
+    opt.window = AudioWindowHanning1024;
+    opt.bandlow = 40.0f;
+    opt.bandhigh = 16000.0f;
+    opt.jobs = std::thread::hardware_concurrency();
+
+    int c;
+    while ((c = getopt(argc, argv, "o:j:w:Cdb:f:kr:c:h")) != -1) {
+        switch (c) {
+        case 'o': opt.outdir = optarg; break;
+        case 'j': opt.jobs = atoi(optarg); break;
+        case 'w': if (!parse_window(optarg, &opt)) usage(); break;
+        case 'C': opt.calibrate = true; break;
+        case 'd': opt.db = true; break;
+        case 'b': opt.bands = atoi(optarg) > FFT_MAX_BANDS ? FFT_MAX_BANDS : atoi(optarg); break;
+        case 'f': if (sscanf(optarg, "%f:%f", &opt.bandlow, &opt.bandhigh) != 2) usage(); break;
+        case 'k': opt.radix8 = true; break;
+        case 'r': opt.raw = true; opt.rawrate = atoi(optarg); break;
+        case 'c': opt.channel = atoi(optarg); break;
+        default: usage();
+        }
+    }
+    if (optind >= argc) usage();
+    const unsigned files = argc - optind;
+    if (opt.jobs < 1) opt.jobs = 1;
+    if (opt.jobs > files) opt.jobs = files;
+
+    std::atomic<unsigned> next(0), failed(0);
+    std::vector<std::thread> workers;
+    for (unsigned j = 0; j < opt.jobs; j++) {
+        workers.push_back(std::thread([&]() {
+            unsigned n;
+            while ((n = next++) < files) {
+                if (!process(argv[optind + n], opt)) failed++;
+            }
+        }));
+    }
+    for (size_t j = 0; j < workers.size(); j++) workers[j].join();
+    return failed ? 1 : 0;
+}
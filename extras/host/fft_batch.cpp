@@ -0,0 +1,188 @@
+#include "fft_batch.h"
+#include "utility/dspinst.h"
+
+#include <chrono>
+
+extern "C" {
+    void arm_cfft_radix4_q15_1024_stage1(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix8_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+}
+
+// frames a worker takes from its own range at a time
+#define FFT_BATCH_CHUNK 8
+
+FFTBatch1024::FFTBatch1024(unsigned threads) : generation(0), idle(0), quit(false),
+    window(AudioWindowHanning1024), windowhalf(false), fftkernel(FFT_KERNEL_RADIX4), simdkernel(NULL),
+    src(NULL), srchop(0), dst(NULL), lastcount(0), elapsed(0.0)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    // the simd tables are built here, before any worker reads them
+    simdkernel = fft_simd_select();
+    arm_cfft_radix4_instance_q15 fft_inst;
+    arm_cfft_radix4_init_fast_q15(&fft_inst, 1024, 0, 0);
+    for (unsigned i = 0; i < threads; i++) {
+        Worker *w = new Worker();
+        w->begin = w->end = 0;
+        w->buffer = NULL;
+        w->fft_inst = fft_inst;
+        workers.push_back(w);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers[i]->thread = std::thread(&FFTBatch1024::workerLoop, this, i);
+    }
+}
+
+FFTBatch1024::~FFTBatch1024()
+{
+    {
+        std::lock_guard<std::mutex> l(poollock);
+        quit = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i]->thread.join();
+        delete workers[i];
+    }
+}
+
+void FFTBatch1024::kernel(uint8_t k)
+{
+    if (k != FFT_KERNEL_RADIX8) k = FFT_KERNEL_RADIX4;
+    fftkernel = k;
+}
+
+bool FFTBatch1024::simd(const char *name)
+{
+    const fft_simd_kernel *k = fft_simd_select(name);
+    if (!k) return false;
+    simdkernel = k;
+    return true;
+}
+
+void FFTBatch1024::run(const int16_t *samples, size_t count, size_t hop, int16_t *output)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const size_t n = workers.size();
+    // every worker starts with an equal contiguous share
+    for (size_t i = 0; i < n; i++) {
+        std::lock_guard<std::mutex> l(workers[i]->lock);
+        workers[i]->begin = count * i / n;
+        workers[i]->end = count * (i + 1) / n;
+    }
+    {
+        std::unique_lock<std::mutex> l(poollock);
+        src = samples;
+        srchop = hop;
+        dst = output;
+        idle = 0;
+        generation++;
+        wake.notify_all();
+        finished.wait(l, [&]() { return idle == n; });
+    }
+    lastcount = count;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The next frames for worker index: a chunk off the front of its own
+// range, or else the back half of the fullest other range. Only one lock
+// is held at a time.
+bool FFTBatch1024::take(unsigned index, size_t *first, size_t *last)
+{
+    Worker *self = workers[index];
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> l(self->lock);
+            if (self->begin < self->end) {
+                *first = self->begin;
+                *last = self->begin + FFT_BATCH_CHUNK < self->end ? self->begin + FFT_BATCH_CHUNK : self->end;
+                self->begin = *last;
+                return true;
+            }
+        }
+        unsigned victim = index;
+        size_t most = 0;
+        for (unsigned i = 0; i < workers.size(); i++) {
+            if (i == index) continue;
+            std::lock_guard<std::mutex> l(workers[i]->lock);
+            if (workers[i]->end - workers[i]->begin > most) {
+                most = workers[i]->end - workers[i]->begin;
+                victim = i;
+            }
+        }
+        if (most == 0) return false;
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> l(workers[victim]->lock);
+            const size_t left = workers[victim]->end - workers[victim]->begin;
+            if (left == 0) continue;
+            end = workers[victim]->end;
+            begin = left <= FFT_BATCH_CHUNK ? workers[victim]->begin : end - left / 2;
+            workers[victim]->end = begin;
+        }
+        std::lock_guard<std::mutex> l(self->lock);
+        self->begin = begin;
+        self->end = end;
+    }
+}
+
+void FFTBatch1024::workerLoop(unsigned index)
+{
+    Worker *w = workers[index];
+    // allocated by the worker itself, so it lands near the core using it
+    void *mem = NULL;
+    if (posix_memalign(&mem, 64, 2048 * sizeof(int16_t)) != 0) abort();
+    w->buffer = (int16_t *)mem;
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> l(poollock);
+            wake.wait(l, [&]() { return quit || generation != seen; });
+            if (quit) break;
+            seen = generation;
+        }
+        size_t first, last;
+        while (take(index, &first, &last)) {
+            for (size_t n = first; n < last; n++) {
+                frame(w, src + n * srchop, dst + n * 512);
+            }
+        }
+        std::lock_guard<std::mutex> l(poollock);
+        if (++idle == workers.size()) finished.notify_one();
+    }
+    free(w->buffer);
+}
+
+// One frame through the analyzer's case 7, 4 and 5 work: copy and window,
+// the three stages and the magnitude loop, bins read in bit reversed order.
+void FFTBatch1024::frame(Worker *w, const int16_t *samples, int16_t *output)
+{
+    uint32_t *buf = (uint32_t *)w->buffer;
+    const int16_t *win = window;
+
+    if (!win) {
+        for (int i=0; i < 1024; i++) buf[i] = (uint16_t)samples[i];
+    } else if (!windowhalf) {
+        for (int i=0; i < 1024; i++) {
+            buf[i] = (uint16_t)signed_saturate_rshift(samples[i] * win[i], 16, 15);
+        }
+    } else {
+        for (int i=0; i < 512; i++) {
+            buf[i] = (uint16_t)signed_saturate_rshift(samples[i] * win[i], 16, 15);
+        }
+        for (int i=512; i < 1024; i++) {
+            buf[i] = (uint16_t)signed_saturate_rshift(samples[i] * win[1023 - i], 16, 15);
+        }
+    }
+    // the vectorized kernels are radix-4 only
+    if (fftkernel == FFT_KERNEL_RADIX8) {
+        arm_cfft_radix4_q15_1024_stage1(&w->fft_inst, w->buffer);
+        arm_cfft_radix8_q15_1024_stage2(&w->fft_inst, w->buffer);
+        arm_cfft_radix4_q15_1024_stage3(&w->fft_inst, w->buffer);
+    } else {
+        simdkernel->fft(w->buffer);
+    }
+    simdkernel->magnitudes(w->buffer, output);
+}
@@ -0,0 +1,85 @@
+// Batch analysis of many independent 1024 point frames on the host, with
+// the staged q15 kernels from fft.c. Each frame gets the same window, fft
+// and magnitude loop as AudioAnalyzeFFT1024_Fast, so its 512 values match
+// output[] bit for bit. Frames are spread over a pool of worker threads,
+// each owning a contiguous range and stealing half of another's range once
+// its own runs dry. Every worker keeps its own fft buffer, the packed
+// twiddle table is shared and read only. The radix-4 stages and the
+// magnitude loop run on the best vectorized kernel of fft_simd.h.
+#ifndef fft_batch_h_
+#define fft_batch_h_
+
+#include "analyze_fft1024_fast.h"
+#include "fft_simd.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class FFTBatch1024
+{
+public:
+    // threads = 0 starts one worker per core
+    FFTBatch1024(unsigned threads = 0);
+    ~FFTBatch1024();
+    // same meaning as on the analyzer, NULL is no window
+    void windowFunction(const int16_t *w) {
+        window = w;
+        windowhalf = false;
+    }
+    void windowSymmetric(const int16_t *half) {
+        window = half;
+        windowhalf = half != NULL;
+    }
+    void kernel(uint8_t k);
+    // picks a fft_simd.h kernel by name, "scalar" runs the fft.c stages,
+    // false if this cpu can't run it
+    bool simd(const char *name);
+    const char * simdName(void) {
+        return simdkernel->name;
+    }
+    // Analyzes count frames, frame n is the 1024 samples from samples +
+    // n * hop, a hop of 512 gives the analyzer's own frames of a stream.
+    // Its 512 magnitudes go to output + n * 512. Returns when all are done.
+    void run(const int16_t *samples, size_t count, size_t hop, int16_t *output);
+    unsigned threads(void) {
+        return workers.size();
+    }
+    // the last run()
+    double seconds(void) {
+        return elapsed;
+    }
+    double framesPerSecond(void) {
+        return elapsed > 0.0 ? lastcount / elapsed : 0.0;
+    }
+private:
+    struct Worker {
+        std::thread thread;
+        std::mutex lock;
+        size_t begin, end;          // frames still to do, guarded by lock
+        int16_t *buffer;            // 2048 q15, one complex frame
+        arm_cfft_radix4_instance_q15 fft_inst;
+        size_t done;
+    };
+    void workerLoop(unsigned index);
+    bool take(unsigned index, size_t *first, size_t *last);
+    void frame(Worker *w, const int16_t *samples, int16_t *output);
+    std::vector<Worker *> workers;
+    std::mutex poollock;
+    std::condition_variable wake, finished;
+    unsigned generation, idle;
+    bool quit;
+    const int16_t *window;
+    bool windowhalf;
+    uint8_t fftkernel;
+    const fft_simd_kernel *simdkernel;
+    // the current run
+    const int16_t *src;
+    size_t srchop;
+    int16_t *dst;
+    size_t lastcount;
+    double elapsed;
+};
+
+#endif
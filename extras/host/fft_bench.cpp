@@ -0,0 +1,101 @@
+// Throughput of the batch engine. Checks the frames of every kernel this
+// cpu runs against the analyzer's own update() pipeline first, times each
+// kernel on one thread, then the chosen one with 1, 2, 4 ... threads.
+
+#include "fft_batch.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+static int16_t *make_signal(size_t length)
+{
+    int16_t *s = (int16_t *)malloc(length * sizeof(int16_t));
+    uint32_t seed = 1;
+    for (size_t n = 0; n < length; n++) {
+        seed = seed * 1664525u + 1013904223u;
+        double v = 0.4 * sin(2.0 * M_PI * (300.0 + n * 0.001) * n / 44100.0) + ((int32_t)seed >> 18) / 32768.0;
+        s[n] = (int16_t)lround(v * 32767.0);
+    }
+    return s;
+}
+
+// the frames the analyzer publishes for the same stream, hop 512
+static bool verify(const int16_t *samples, size_t frames, const int16_t *batch, bool radix8)
+{
+    AudioAnalyzeFFT1024_Fast fft;
+    if (radix8) fft.kernel(FFT_KERNEL_RADIX8);
+    size_t published = 0;
+    for (size_t pos = 0; published < frames; pos += AUDIO_BLOCK_SAMPLES) {
+        audio_block_t *block = AudioStream::allocate();
+        memcpy(block->data, samples + pos, sizeof(block->data));
+        fft.hostInject(block);
+        fft.update();
+        if (!fft.available()) continue;
+        if (memcmp(fft.output, batch + published * 512, sizeof(fft.output)) != 0) {
+            fprintf(stderr, "frame %zu differs from the analyzer\n", published);
+            return false;
+        }
+        published++;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    size_t frames = 20000;
+    unsigned maxthreads = std::thread::hardware_concurrency();
+    bool radix8 = false;
+    const char *simd = NULL;
+    int c;
+    while ((c = getopt(argc, argv, "n:j:ks:")) != -1) {
+        switch (c) {
+        case 'n': frames = strtoul(optarg, NULL, 10); break;
+        case 'j': maxthreads = atoi(optarg); break;
+        case 'k': radix8 = true; break;
+        case 's': simd = optarg; break;
+        default:
+            fprintf(stderr, "usage: fft_bench [-n frames] [-j max threads] [-k radix-8] [-s scalar|sse4.1|avx2|neon]\n");
+            return 2;
+        }
+    }
+    if (frames < 16) frames = 16;
+    if (maxthreads < 1) maxthreads = 1;
+
+    // enough for the analyzer to publish frames + 1 frames with a hop of 512
+    const size_t length = (frames + 4) * 512;
+    int16_t *samples = make_signal(length);
+    int16_t *output = (int16_t *)malloc(frames * 512 * sizeof(int16_t));
+
+    const char *kernels[] = { "scalar", "sse4.1", "avx2", "neon" };
+    printf("kernel     frames/s   (1 thread)\n");
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        FFTBatch1024 batch(1);
+        if (!batch.simd(kernels[k])) continue;
+        if (radix8) batch.kernel(FFT_KERNEL_RADIX8);
+        const size_t check = frames < 256 ? frames : 256;
+        batch.run(samples, check, 512, output);
+        if (!verify(samples, check, output, radix8)) return 1;
+        batch.run(samples, frames, 512, output);
+        printf("%-8s %10.0f   %zu frames match output[]\n", kernels[k], batch.framesPerSecond(), check);
+    }
+    if (simd && !fft_simd_select(simd)) {
+        fprintf(stderr, "kernel %s is not available\n", simd);
+        return 2;
+    }
+
+    double single = 0.0;
+    printf("\n%s\nthreads   frames/s   speedup\n", fft_simd_select(simd)->name);
+    for (unsigned t = 1; t <= maxthreads; t = t < maxthreads && t * 2 > maxthreads ? maxthreads : t * 2) {
+        FFTBatch1024 batch(t);
+        if (simd) batch.simd(simd);
+        if (radix8) batch.kernel(FFT_KERNEL_RADIX8);
+        batch.run(samples, frames < 1000 ? frames : 1000, 512, output);  // warm up
+        batch.run(samples, frames, 512, output);
+        if (t == 1) single = batch.framesPerSecond();
+        printf("%7u %10.0f %9.2f\n", t, batch.framesPerSecond(), batch.framesPerSecond() / single);
+        if (t == maxthreads) break;
+    }
+    free(output);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,484 @@
+// Record and replay harness for the update() state machine. A script of
+// sines, chirps, noise, dropped blocks and updates without a block is
+// turned into the exact sequence of update() calls the audio library
+// would make, one block or none per call. Every published frame is kept
+// with the call that published it, and each call is timed by the slot of
+// the 8 state cycle it runs in.
+//
+//   fft_replay script                  run it and print the slot timing
+//   fft_replay -o capture script       also save blocks, frames and timing
+//   fft_replay -r capture              run the saved blocks again, check
+//                                      every frame and compare the timing
+//
+// A capture holds the blocks themselves, so a replay feeds the analyzer
+// the same samples whatever libm the generators were run with. Script,
+// one command per line, # starts a comment:
+//   window hanning|...|none            default hanning
+//   schedule flat|lowlatency|hybrid|deferred [yield]
+//   kernel radix4|radix8
+//   db on|off
+//   yields n                           yield() calls after each update
+//   rate hz                            default 44100
+//   seed n                             for noise
+//   floor amp                          noise added to every source
+//   sine hz amp blocks
+//   chirp hz0 hz1 amp blocks           linear sweep
+//   noise amp blocks
+//   silence blocks
+//   drop blocks                        the source runs on, update() gets
+//                                      no block, as when a block is lost
+//   null updates                       update() gets no block, the source
+//                                      waits
+// Amplitudes are fractions of full scale.
+
+#include "analyze_fft1024_fast.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define REPLAY_MAGIC    0x4C505246u  // "FRPL"
+#define REPLAY_VERSION  1
+// slots 0 to 7 are the update() states, the last one is yield()
+#define REPLAY_SLOTS    9
+
+struct replay_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t scriptBytes;   // script text follows the header
+    uint32_t updates;       // then one byte per update(), 1 if it had a block
+    uint32_t blocks;        // then the blocks, AUDIO_BLOCK_SAMPLES int16_t each
+    uint32_t frames;        // then per frame the update index and output[]
+    uint32_t slots;         // then per slot calls, median and max ns
+};
+
+struct settings {
+    const int16_t *window;
+    uint8_t policy, kernel;
+    bool yield, db;
+    unsigned yields;
+};
+
+struct frame {
+    uint32_t update;
+    int16_t output[512];
+};
+
+struct slot_timing {
+    uint32_t calls, median, max;
+};
+
+struct result {
+    std::vector<frame> frames;
+    slot_timing slots[REPLAY_SLOTS];
+    // blocks received after a frame's last block until the update that
+    // published it, over frames without a gap, not kept in a capture
+    uint32_t latencymin, latencymax;
+    uint32_t overruns;
+    int leaked;
+};
+
+static const struct {
+    const char *name;
+    const int16_t *table;
+} windows[] = {
+    { "hanning", AudioWindowHanning1024 },
+    { "bartlett", AudioWindowBartlett1024 },
+    { "blackman", AudioWindowBlackman1024 },
+    { "flattop", AudioWindowFlattop1024 },
+    { "blackmanharris", AudioWindowBlackmanHarris1024 },
+    { "nuttall", AudioWindowNuttall1024 },
+    { "blackmannuttall", AudioWindowBlackmanNuttall1024 },
+    { "welch", AudioWindowWelch1024 },
+    { "hamming", AudioWindowHamming1024 },
+    { "cosine", AudioWindowCosine1024 },
+    { "tukey", AudioWindowTukey1024 },
+    { "none", NULL },
+};
+
+static const char *policies[] = { "flat", "lowlatency", "hybrid", "deferred" };
+
+// the current source, drop keeps it running
+struct source {
+    double f0, f1, amp;
+    bool noise;
+};
+
+// Settings lines set s, source lines append to updates and blocks when
+// they are given. Returns false with a message for a line it can't read.
+static bool parse_script(const std::string &text, settings *s,
+    std::vector<uint8_t> *updates, std::vector<int16_t> *blocks)
+{
+    double rate = 44100.0, noisefloor = 0.0, phase = 0.0;
+    uint32_t seed = 1;
+    source src = { 0.0, 0.0, 0.0, false };
+    s->window = AudioWindowHanning1024;
+    s->policy = FFT_SCHEDULE_FLAT;
+    s->kernel = FFT_KERNEL_RADIX4;
+    s->yield = s->db = false;
+    s->yields = 8;
+
+    size_t pos = 0;
+    for (unsigned line = 1; pos < text.size(); line++) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string l = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (l.find('#') != std::string::npos) l.erase(l.find('#'));
+        char cmd[32] = "", arg[32] = "", opt[32] = "";
+        if (sscanf(l.c_str(), "%31s %31s %31s", cmd, arg, opt) <= 0) continue;
+        const char *args = l.c_str() + l.find(cmd) + strlen(cmd);
+        double a = 0, b = 0, c = 0;
+        unsigned n = 0;
+        bool ok = true, deliver = true;
+        if (strcmp(cmd, "window") == 0) {
+            ok = false;
+            for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+                if (strcmp(arg, windows[i].name) == 0) {
+                    s->window = windows[i].table;
+                    ok = true;
+                }
+            }
+        } else if (strcmp(cmd, "schedule") == 0) {
+            ok = false;
+            for (uint8_t i = 0; i < 4; i++) {
+                if (strcmp(arg, policies[i]) == 0) {
+                    s->policy = i;
+                    ok = true;
+                }
+            }
+            s->yield = strcmp(opt, "yield") == 0;
+        } else if (strcmp(cmd, "kernel") == 0) {
+            ok = strcmp(arg, "radix4") == 0 || strcmp(arg, "radix8") == 0;
+            s->kernel = strcmp(arg, "radix8") == 0 ? FFT_KERNEL_RADIX8 : FFT_KERNEL_RADIX4;
+        } else if (strcmp(cmd, "db") == 0) {
+            ok = strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0;
+            s->db = strcmp(arg, "on") == 0;
+        } else if (strcmp(cmd, "yields") == 0) {
+            ok = sscanf(args, "%u", &s->yields) == 1;
+        } else if (strcmp(cmd, "rate") == 0) {
+            ok = sscanf(args, "%lf", &rate) == 1 && rate > 0;
+        } else if (strcmp(cmd, "seed") == 0) {
+            ok = sscanf(args, "%u", &seed) == 1;
+        } else if (strcmp(cmd, "floor") == 0) {
+            ok = sscanf(args, "%lf", &noisefloor) == 1;
+        } else if (strcmp(cmd, "null") == 0) {
+            ok = sscanf(args, "%u", &n) == 1;
+            if (ok && updates) updates->insert(updates->end(), n, 0);
+            n = 0;
+        } else if (strcmp(cmd, "sine") == 0) {
+            ok = sscanf(args, "%lf %lf %u", &a, &b, &n) == 3;
+            src.f0 = src.f1 = a;
+            src.amp = b;
+            src.noise = false;
+        } else if (strcmp(cmd, "chirp") == 0) {
+            ok = sscanf(args, "%lf %lf %lf %u", &a, &b, &c, &n) == 4;
+            src.f0 = a;
+            src.f1 = b;
+            src.amp = c;
+            src.noise = false;
+        } else if (strcmp(cmd, "noise") == 0) {
+            ok = sscanf(args, "%lf %u", &a, &n) == 2;
+            src.amp = a;
+            src.noise = true;
+        } else if (strcmp(cmd, "silence") == 0) {
+            ok = sscanf(args, "%u", &n) == 1;
+            src.amp = 0.0;
+            src.noise = false;
+        } else if (strcmp(cmd, "drop") == 0) {
+            ok = sscanf(args, "%u", &n) == 1;
+            deliver = false;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "script line %u: can't read \"%s\"\n", line, l.c_str());
+            return false;
+        }
+        if (!updates) continue;
+        const uint32_t total = n * AUDIO_BLOCK_SAMPLES;
+        for (uint32_t k = 0; k < total; k++) {
+            double v = 0.0;
+            if (src.noise) {
+                seed = seed * 1664525u + 1013904223u;
+                v = src.amp * ((int32_t)seed / 2147483648.0);
+            } else if (src.amp != 0.0) {
+                v = src.amp * sin(2.0 * M_PI * phase);
+                phase += (src.f0 + (src.f1 - src.f0) * k / total) / rate;
+                phase -= floor(phase);
+            }
+            if (noisefloor != 0.0) {
+                seed = seed * 1664525u + 1013904223u;
+                v += noisefloor * ((int32_t)seed / 2147483648.0);
+            }
+            if (k % AUDIO_BLOCK_SAMPLES == 0) updates->push_back(deliver);
+            if (!deliver) continue;
+            long q = lround(v * 32767.0);
+            blocks->push_back(q > 32767 ? 32767 : q < -32768 ? -32768 : q);
+        }
+        // a chirp ends on its last frequency, a drop runs on from there
+        src.f0 = src.f1;
+    }
+    return true;
+}
+
+// the state update() runs in after n blocks, also the blocks it holds
+static unsigned slot_of(uint32_t n)
+{
+    return n < 8 ? n : 4 + (n - 8) % 4;
+}
+
+static void run(const settings &s, const std::vector<uint8_t> &updates,
+    const std::vector<int16_t> &blocks, result *r)
+{
+    AudioAnalyzeFFT1024_Fast fft;
+    fft.windowFunction(s.window);
+    fft.schedule(s.policy, s.yield);
+    fft.kernel(s.kernel);
+    fft.outputDB(s.db);
+    std::vector<uint32_t> times[REPLAY_SLOTS];
+    const int16_t *data = blocks.data();
+    uint32_t received = 0;
+    std::vector<uint32_t> receivedat(updates.size());
+    const int before = AudioStream::allocated();
+
+    r->frames.clear();
+    r->latencymin = UINT32_MAX;
+    r->latencymax = 0;
+    for (uint32_t u = 0; u < updates.size(); u++) {
+        unsigned slot = REPLAY_SLOTS - 1;
+        if (updates[u]) {
+            audio_block_t *block = AudioStream::allocate();
+            memcpy(block->data, data, sizeof(block->data));
+            data += AUDIO_BLOCK_SAMPLES;
+            fft.hostInject(block);
+            slot = slot_of(received++);
+        }
+        receivedat[u] = received;
+        uint32_t t0 = ARM_DWT_CYCCNT;
+        fft.update();
+        uint32_t t1 = ARM_DWT_CYCCNT;
+        if (updates[u]) times[slot].push_back(t1 - t0);
+        for (unsigned y = 0; s.yield && y < s.yields; y++) {
+            t0 = ARM_DWT_CYCCNT;
+            yield();
+            times[REPLAY_SLOTS - 1].push_back(ARM_DWT_CYCCNT - t0);
+        }
+        if (fft.available()) {
+            frame f;
+            f.update = u;
+            memcpy(f.output, fft.output, sizeof(f.output));
+            r->frames.push_back(f);
+            if (!fft.frameGap()) {
+                const uint32_t last = (fft.frameSample() + 1024) / AUDIO_BLOCK_SAMPLES - 1;
+                const uint32_t latency = receivedat[u] - receivedat[last];
+                r->latencymin = std::min(r->latencymin, latency);
+                r->latencymax = std::max(r->latencymax, latency);
+            }
+        }
+    }
+    for (int i = 0; i < REPLAY_SLOTS; i++) {
+        std::vector<uint32_t> &t = times[i];
+        r->slots[i].calls = t.size();
+        r->slots[i].median = r->slots[i].max = 0;
+        if (t.empty()) continue;
+        std::sort(t.begin(), t.end());
+        r->slots[i].median = t[t.size() / 2];
+        r->slots[i].max = t.back();
+    }
+    r->overruns = fft.overruns();
+    r->leaked = AudioStream::allocated() - before - slot_of(received);
+}
+
+static void print_timing(const result &r, const result *recorded)
+{
+    printf("slot     calls   median ns    max ns%s\n", recorded ? "   recorded median   max" : "");
+    for (int i = 0; i < REPLAY_SLOTS; i++) {
+        const slot_timing &t = r.slots[i];
+        if (!t.calls) continue;
+        if (i < REPLAY_SLOTS - 1) printf("%4d", i);
+        else printf("yield");
+        printf("%*u %11u %9u", i < REPLAY_SLOTS - 1 ? 10 : 5, t.calls, t.median, t.max);
+        if (recorded) printf("   %15u %5u", recorded->slots[i].median, recorded->slots[i].max);
+        printf("\n");
+    }
+    printf("%zu frames, %u overruns\n", r.frames.size(), r.overruns);
+    if (r.latencymin <= r.latencymax) {
+        printf("published %u to %u blocks after the frame's last block\n", r.latencymin, r.latencymax);
+    }
+}
+
+// the heaviest slot by its median, steadier than the max on a desktop
+static uint32_t peak_cost(const result &r)
+{
+    uint32_t peak = 0;
+    for (int i = 0; i < REPLAY_SLOTS; i++) peak = std::max(peak, r.slots[i].median);
+    return peak;
+}
+
+static bool read_file(const char *name, std::string *text)
+{
+    FILE *f = fopen(name, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", name, strerror(errno));
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text->append(buf, n);
+    fclose(f);
+    return true;
+}
+
+static bool save(const char *name, const std::string &script, const std::vector<uint8_t> &updates,
+    const std::vector<int16_t> &blocks, const result &r)
+{
+    FILE *f = fopen(name, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", name, strerror(errno));
+        return false;
+    }
+    replay_header h;
+    h.magic = REPLAY_MAGIC;
+    h.version = REPLAY_VERSION;
+    h.scriptBytes = script.size();
+    h.updates = updates.size();
+    h.blocks = blocks.size() / AUDIO_BLOCK_SAMPLES;
+    h.frames = r.frames.size();
+    h.slots = REPLAY_SLOTS;
+    fwrite(&h, sizeof(h), 1, f);
+    fwrite(script.data(), 1, script.size(), f);
+    fwrite(updates.data(), 1, updates.size(), f);
+    fwrite(blocks.data(), sizeof(int16_t), blocks.size(), f);
+    for (size_t i = 0; i < r.frames.size(); i++) {
+        fwrite(&r.frames[i].update, sizeof(uint32_t), 1, f);
+        fwrite(r.frames[i].output, sizeof(int16_t), 512, f);
+    }
+    fwrite(r.slots, sizeof(slot_timing), REPLAY_SLOTS, f);
+    if (fclose(f) != 0) {
+        fprintf(stderr, "%s: %s\n", name, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool load(const char *name, std::string *script, std::vector<uint8_t> *updates,
+    std::vector<int16_t> *blocks, result *r)
+{
+    std::string data;
+    if (!read_file(name, &data)) return false;
+    replay_header h;
+    const uint8_t *p = (const uint8_t *)data.data(), *end = p + data.size();
+    if (data.size() < sizeof(h)) goto bad;
+    memcpy(&h, p, sizeof(h));
+    p += sizeof(h);
+    if (h.magic != REPLAY_MAGIC || h.version != REPLAY_VERSION || h.slots != REPLAY_SLOTS) goto bad;
+    if ((size_t)(end - p) != h.scriptBytes + h.updates + (size_t)h.blocks * AUDIO_BLOCK_SAMPLES * 2
+        + (size_t)h.frames * (4 + 1024) + REPLAY_SLOTS * sizeof(slot_timing)) goto bad;
+    script->assign((const char *)p, h.scriptBytes);
+    p += h.scriptBytes;
+    updates->assign(p, p + h.updates);
+    p += h.updates;
+    blocks->resize((size_t)h.blocks * AUDIO_BLOCK_SAMPLES);
+    memcpy(blocks->data(), p, blocks->size() * 2);
+    p += blocks->size() * 2;
+    r->frames.resize(h.frames);
+    for (size_t i = 0; i < h.frames; i++) {
+        memcpy(&r->frames[i].update, p, 4);
+        memcpy(r->frames[i].output, p + 4, 1024);
+        p += 4 + 1024;
+    }
+    memcpy(r->slots, p, sizeof(r->slots));
+    if ((size_t)std::count(updates->begin(), updates->end(), 1) != h.blocks) goto bad;
+    return true;
+bad:
+    fprintf(stderr, "%s: not a replay capture\n", name);
+    return false;
+}
+
+// every frame must come out of the same update() with the same bins
+static bool compare(const result &now, const result &then)
+{
+    size_t n = std::min(now.frames.size(), then.frames.size());
+    for (size_t i = 0; i < n; i++) {
+        const frame &a = now.frames[i], &b = then.frames[i];
+        if (a.update != b.update) {
+            printf("frame %zu published by update %u, recorded by update %u\n", i, a.update, b.update);
+            return false;
+        }
+        if (memcmp(a.output, b.output, sizeof(a.output)) != 0) {
+            int bin = 0;
+            while (a.output[bin] == b.output[bin]) bin++;
+            printf("frame %zu differs from bin %d: %d, recorded %d\n", i, bin, a.output[bin], b.output[bin]);
+            return false;
+        }
+    }
+    if (now.frames.size() != then.frames.size()) {
+        printf("%zu frames, recorded %zu\n", now.frames.size(), then.frames.size());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *outname = NULL, *capture = NULL;
+    double tolerance = -1.0;
+    int c;
+    while ((c = getopt(argc, argv, "o:r:t:")) != -1) {
+        switch (c) {
+        case 'o': outname = optarg; break;
+        case 'r': capture = optarg; break;
+        case 't': tolerance = atof(optarg); break;
+        default:
+            goto usage;
+        }
+    }
+    if (capture ? optind != argc : optind != argc - 1) goto usage;
+    {
+        std::string script;
+        std::vector<uint8_t> updates;
+        std::vector<int16_t> blocks;
+        settings s;
+        result now, then;
+        if (capture) {
+            if (!load(capture, &script, &updates, &blocks, &then)) return 1;
+            if (!parse_script(script, &s, NULL, NULL)) return 1;
+        } else {
+            if (!read_file(argv[optind], &script)) return 1;
+            if (!parse_script(script, &s, &updates, &blocks)) return 1;
+        }
+        printf("%zu updates, %zu blocks, schedule %s%s\n", updates.size(), blocks.size() / AUDIO_BLOCK_SAMPLES,
+            policies[s.policy], s.yield ? " from yield()" : "");
+        run(s, updates, blocks, &now);
+        print_timing(now, capture ? &then : NULL);
+        int rc = 0;
+        if (now.leaked) {
+            printf("%d audio blocks leaked\n", now.leaked);
+            rc = 1;
+        }
+        if (capture) {
+            if (compare(now, then)) {
+                printf("all %zu frames match the capture\n", now.frames.size());
+            } else {
+                rc = 1;
+            }
+            double change = 100.0 * ((double)peak_cost(now) / peak_cost(then) - 1.0);
+            printf("peak slot %u ns, recorded %u ns (%+.1f%%)\n", peak_cost(now), peak_cost(then), change);
+            if (tolerance >= 0.0 && change > tolerance) {
+                printf("peak cost is more than %.1f%% over the capture\n", tolerance);
+                rc = 1;
+            }
+        }
+        if (outname && !save(outname, script, updates, blocks, now)) rc = 1;
+        return rc;
+    }
+usage:
+    fprintf(stderr, "usage: fft_replay [-o capture] script\n"
+        "       fft_replay -r capture [-t percent over the recorded peak slot cost]\n");
+    return 2;
+}
@@ -0,0 +1,93 @@
+#include "fft_simd.h"
+#include "arm_math.h"
+#include "utility/sqrt_integer.h"
+#include "utility/dspinst.h"
+
+#include <string.h>
+
+extern "C" {
+    arm_status arm_cfft_radix4_init_fast_q15(arm_cfft_radix4_instance_q15 * S, uint16_t fftLen, uint8_t ifftFlag, uint8_t bitReverseFlag);
+    void arm_cfft_radix4_q15_1024_stage1(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+    void arm_cfft_radix4_q15_1024_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+extern const fft_simd_kernel fft_simd_kernel_sse41;
+extern const fft_simd_kernel fft_simd_kernel_avx2;
+#elif defined(__aarch64__)
+extern const fft_simd_kernel fft_simd_kernel_neon;
+#endif
+
+fft_simd_tables fft_simd_tab;
+static arm_cfft_radix4_instance_q15 fft_inst;
+
+// the fft.c stages, the reference the others match
+static void fft_scalar(int16_t *buf)
+{
+    arm_cfft_radix4_q15_1024_stage1(&fft_inst, buf);
+    arm_cfft_radix4_q15_1024_stage2(&fft_inst, buf);
+    arm_cfft_radix4_q15_1024_stage3(&fft_inst, buf);
+}
+
+static void magnitudes_scalar(const int16_t *buf, int16_t *output)
+{
+    const uint32_t *w = (const uint32_t *)buf;
+    for (int i = 0; i < 512; i++) {
+        uint32_t tmp = w[fft_simd_tab.binindex[i]];
+        output[i] = sqrt_uint32_approx(multiply_16tx16t_add_16bx16b(tmp, tmp));
+    }
+}
+
+static const fft_simd_kernel fft_simd_kernel_scalar = {
+    "scalar",
+    fft_scalar,
+    magnitudes_scalar
+};
+
+// The twiddles come from the instance table like the packed table in
+// fft.c: pass p (span 1024 >> 2p) uses W^mj at table step m * j * 4^p.
+static void tables_init(void)
+{
+    arm_cfft_radix4_init_fast_q15(&fft_inst, 1024, 0, 0);
+    for (unsigned p = 0; p < 4; p++) {
+        const unsigned n2 = 256 >> (2 * p), step = fft_inst.twidCoefModifier << (2 * p);
+        for (unsigned m = 1; m <= 3; m++) {
+            for (unsigned j = 0; j < n2; j++) {
+                const q15_t *c = fft_inst.pTwiddle + 2 * (m * j * step);
+                fft_simd_tab.twiddle[p][m-1][j] = (uint16_t)c[0] | ((uint32_t)(uint16_t)c[1] << 16);
+                fft_simd_tab.twiddleneg[p][m-1][j] = (uint16_t)c[0] | ((uint32_t)(uint16_t)-c[1] << 16);
+            }
+        }
+    }
+    for (unsigned i = 0; i < 512; i++) {
+        fft_simd_tab.binindex[i] = __RBIT(i) >> 22;
+    }
+    for (unsigned e = 0; e < 32; e++) {
+        fft_simd_tab.guess[e] = sqrt_integer_guess_table[31 - e];
+    }
+}
+
+const fft_simd_kernel * fft_simd_select(const char *name)
+{
+    static bool ready = false;
+    if (!ready) {
+        tables_init();
+        ready = true;
+    }
+    const fft_simd_kernel *candidates[4];
+    int count = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) candidates[count++] = &fft_simd_kernel_avx2;
+    if (__builtin_cpu_supports("sse4.1")) candidates[count++] = &fft_simd_kernel_sse41;
+#elif defined(__aarch64__)
+    candidates[count++] = &fft_simd_kernel_neon;
+#endif
+    candidates[count++] = &fft_simd_kernel_scalar;
+    if (!name) return candidates[0];
+    for (int i = 0; i < count; i++) {
+        if (strcmp(candidates[i]->name, name) == 0) return candidates[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,40 @@
+// Vectorized host versions of the 1024 point radix-4 stages and the
+// magnitude loop. They keep the device's packed (re, im) q15 buffer and
+// run several butterflies per instruction with SSE4.1, AVX2 or NEON
+// operations that round and saturate exactly like the Cortex-M4 ones, so
+// the bins are bit for bit the same as fft.c on the device. The kernel is
+// picked at runtime from what the cpu supports.
+#ifndef fft_simd_h_
+#define fft_simd_h_
+
+#include <stdint.h>
+
+struct fft_simd_kernel {
+    const char *name;
+    // stage 1, 2 and 3 in place on a 2048 q15 frame, no bit reversal
+    void (*fft)(int16_t *buf);
+    // output[i] = sqrt_uint32_approx(|bin i|^2), the analyzer's output[]
+    void (*magnitudes)(const int16_t *buf, int16_t *output);
+};
+
+// The best kernel this cpu runs, or the one called name ("scalar",
+// "sse4.1", "avx2", "neon"), NULL when that one is not available here.
+// Builds the shared tables on the first call, call it before starting
+// threads.
+const fft_simd_kernel * fft_simd_select(const char *name = 0);
+
+// shared by the kernels, built by fft_simd_select()
+struct fft_simd_tables {
+    // per radix-4 pass (span 1024, 256, 64, 16): W^j, W^2j, W^3j packed
+    // like the CMSIS table (cos low, sin high), and with the sine negated
+    int32_t twiddle[4][3][256] __attribute__ ((aligned (64)));
+    int32_t twiddleneg[4][3][256] __attribute__ ((aligned (64)));
+    // word index of bin i, its 10 bit reversal
+    int32_t binindex[512] __attribute__ ((aligned (64)));
+    // sqrt_integer_guess_table by exponent, guess[e] is the guess for
+    // inputs with e + 1 significant bits
+    int32_t guess[32] __attribute__ ((aligned (64)));
+};
+extern fft_simd_tables fft_simd_tab;
+
+#endif
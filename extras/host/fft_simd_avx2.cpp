@@ -0,0 +1,40 @@
+// built with -mavx2
+#include "fft_simd_x86.h"
+
+// two newton steps on 4 lanes, none of them 0
+static inline __m128i sqrt_quad(__m128i in)
+{
+    __m256d d = _mm256_add_pd(_mm256_cvtepi32_pd(_mm_xor_si128(in, _mm_set1_epi32(0x80000000))), _mm256_set1_pd(2147483648.0));
+    __m256i e = _mm256_sub_epi64(_mm256_srli_epi64(_mm256_castpd_si256(d), 52), _mm256_set1_epi64x(1023));
+    const int32_t *guess = fft_simd_tab.guess;
+    __m128i n = _mm_setr_epi32(guess[_mm256_extract_epi64(e, 0)], guess[_mm256_extract_epi64(e, 1)],
+        guess[_mm256_extract_epi64(e, 2)], guess[_mm256_extract_epi64(e, 3)]);
+    n = _mm_srli_epi32(_mm_add_epi32(_mm256_cvttpd_epi32(_mm256_div_pd(d, _mm256_cvtepi32_pd(n))), n), 1);
+    n = _mm_srli_epi32(_mm_add_epi32(_mm256_cvttpd_epi32(_mm256_div_pd(d, _mm256_cvtepi32_pd(n))), n), 1);
+    return n;
+}
+
+static void magnitudes_avx2(const int16_t *buf, int16_t *output)
+{
+    const int32_t *w = (const int32_t *)buf;
+    const int32_t *index = fft_simd_tab.binindex;
+
+    // plain loads, gathers are slower than these on many cores
+    for (int i = 0; i < 512; i += 8) {
+        __m256i t = _mm256_setr_epi32(w[index[i]], w[index[i+1]], w[index[i+2]], w[index[i+3]],
+            w[index[i+4]], w[index[i+5]], w[index[i+6]], w[index[i+7]]);
+        __m256i magsq = _mm256_madd_epi16(t, t);
+        __m256i in = _mm256_max_epu32(magsq, _mm256_set1_epi32(1));
+        __m256i zero = _mm256_cmpeq_epi32(magsq, _mm256_setzero_si256());
+        __m128i lo = _mm_andnot_si128(_mm256_castsi256_si128(zero), sqrt_quad(_mm256_castsi256_si128(in)));
+        __m128i hi = _mm_andnot_si128(_mm256_extracti128_si256(zero, 1), sqrt_quad(_mm256_extracti128_si256(in, 1)));
+        _mm_storeu_si128((__m128i *)(output + i), _mm_packus_epi32(lo, hi));
+    }
+}
+
+// the span 16 pass has groups of 4, it runs 128 bits wide
+extern const fft_simd_kernel fft_simd_kernel_avx2 = {
+    "avx2",
+    fft_simd_fft<fft_simd_avx2, fft_simd_sse41>,
+    magnitudes_avx2
+};
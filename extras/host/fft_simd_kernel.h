@@ -0,0 +1,122 @@
+// The radix-4 stages written once over a vector traits class V, included
+// by each instruction set's source file. V::vec holds V::words packed
+// (re, im) q15 words, one butterfly each, and every V operation matches
+// the Cortex-M4 instruction of the same name on each 16 bit half:
+//   qadd, qsub        __QADD16, __QSUB16     saturating
+//   shadd, shsub      __SHADD16, __SHSUB16   halving, rounding down
+//   qasx, qsax        __QASX, __QSAX         saturating cross add/sub
+//   shasx, shsax      __SHASX, __SHSAX       halving cross add/sub
+//   shr1, shr2        arithmetic shift right of each half
+//   cmul(c, cn, r)    high halves of __SMUSDX(c, r) and __SMUAD(c, r),
+//                     the twiddle multiply, cn is c with the sine negated
+// The passes follow fft.c operation for operation, passes whose groups
+// are narrower than V::words run with the narrower traits N.
+#ifndef fft_simd_kernel_h_
+#define fft_simd_kernel_h_
+
+#include "fft_simd.h"
+
+template <class V>
+static inline void fft_simd_twiddle(const int32_t *t, const int32_t *tn, unsigned j,
+    typename V::vec *c1, typename V::vec *c1n, typename V::vec *c2, typename V::vec *c2n,
+    typename V::vec *c3, typename V::vec *c3n)
+{
+    *c1 = V::load(t + j);
+    *c2 = V::load(t + 256 + j);
+    *c3 = V::load(t + 512 + j);
+    *c1n = V::load(tn + j);
+    *c2n = V::load(tn + 256 + j);
+    *c3n = V::load(tn + 512 + j);
+}
+
+// stage 1, span 1024, inputs scaled down by 4 as they are read
+template <class V>
+static void fft_simd_stage1(int16_t *buf)
+{
+    typedef typename V::vec vec;
+    int32_t *x = (int32_t *)buf;
+    const int32_t *t = fft_simd_tab.twiddle[0][0], *tn = fft_simd_tab.twiddleneg[0][0];
+
+    for (unsigned j = 0; j < 256; j += V::words) {
+        vec c1, c1n, c2, c2n, c3, c3n;
+        fft_simd_twiddle<V>(t, tn, j, &c1, &c1n, &c2, &c2n, &c3, &c3n);
+        int32_t *x0 = x + j, *x1 = x0 + 256, *x2 = x0 + 512, *x3 = x0 + 768;
+        vec a = V::shr2(V::load(x0)), b = V::shr2(V::load(x1));
+        vec c = V::shr2(V::load(x2)), d = V::shr2(V::load(x3));
+        vec r = V::qadd(a, c), s = V::qsub(a, c), u = V::qadd(b, d);
+        V::store(x0, V::shadd(r, u));
+        r = V::qsub(r, u);
+        V::store(x1, V::cmul(c2, c2n, r));
+        u = V::qsub(b, d);
+        r = V::qasx(s, u);
+        s = V::qsax(s, u);
+        V::store(x2, V::cmul(c1, c1n, s));
+        V::store(x3, V::cmul(c3, c3n, r));
+    }
+}
+
+// one middle pass, span n1, pass p of the twiddle tables
+template <class V>
+static void fft_simd_middle(int16_t *buf, unsigned n1, unsigned p)
+{
+    typedef typename V::vec vec;
+    int32_t *x = (int32_t *)buf;
+    const unsigned n2 = n1 >> 2;
+    const int32_t *t = fft_simd_tab.twiddle[p][0], *tn = fft_simd_tab.twiddleneg[p][0];
+
+    for (unsigned j = 0; j < n2; j += V::words) {
+        vec c1, c1n, c2, c2n, c3, c3n;
+        fft_simd_twiddle<V>(t, tn, j, &c1, &c1n, &c2, &c2n, &c3, &c3n);
+        for (unsigned i0 = j; i0 < 1024; i0 += n1) {
+            int32_t *x0 = x + i0, *x1 = x0 + n2, *x2 = x1 + n2, *x3 = x2 + n2;
+            vec a = V::load(x0), b = V::load(x1), c = V::load(x2), d = V::load(x3);
+            vec r = V::qadd(a, c), s = V::qsub(a, c), u = V::qadd(b, d);
+            V::store(x0, V::shr1(V::shadd(r, u)));
+            r = V::shsub(r, u);
+            V::store(x1, V::cmul(c2, c2n, r));
+            u = V::qsub(b, d);
+            r = V::shasx(s, u);
+            s = V::shsax(s, u);
+            V::store(x2, V::cmul(c1, c1n, s));
+            V::store(x3, V::cmul(c3, c3n, r));
+        }
+    }
+}
+
+// last stage, span 4 with unit twiddles: the four words of a butterfly
+// are adjacent, so groups of 4 butterflies are transposed in and out
+template <class V>
+static void fft_simd_stage3(int16_t *buf)
+{
+    typedef typename V::vec vec;
+    int32_t *x = (int32_t *)buf;
+
+    for (unsigned i = 0; i < 1024; i += 4 * V::words) {
+        vec a = V::load(x + i), b = V::load(x + i + V::words);
+        vec c = V::load(x + i + 2 * V::words), d = V::load(x + i + 3 * V::words);
+        V::transpose4(&a, &b, &c, &d);
+        vec r = V::qadd(a, c), u = V::qadd(b, d);
+        vec s = V::qsub(a, c), w = V::qsub(b, d);
+        a = V::shadd(r, u);
+        b = V::shsub(r, u);
+        c = V::shsax(s, w);
+        d = V::shasx(s, w);
+        V::transpose4(&a, &b, &c, &d);
+        V::store(x + i, a);
+        V::store(x + i + V::words, b);
+        V::store(x + i + 2 * V::words, c);
+        V::store(x + i + 3 * V::words, d);
+    }
+}
+
+template <class V, class N>
+static void fft_simd_fft(int16_t *buf)
+{
+    fft_simd_stage1<V>(buf);
+    fft_simd_middle<V>(buf, 256, 1);
+    fft_simd_middle<V>(buf, 64, 2);
+    fft_simd_middle<N>(buf, 16, 3);
+    fft_simd_stage3<V>(buf);
+}
+
+#endif
@@ -0,0 +1,92 @@
+// AArch64 NEON, where the halving and saturating 16 bit operations are
+// single instructions like on the Cortex-M4
+#include "fft_simd_kernel.h"
+#include <arm_neon.h>
+
+struct fft_simd_neon {
+    typedef int16x8_t vec;
+    enum { words = 4 };
+    static inline vec load(const int32_t *p) {
+        return vreinterpretq_s16_s32(vld1q_s32(p));
+    }
+    static inline void store(int32_t *p, vec v) {
+        vst1q_s32(p, vreinterpretq_s32_s16(v));
+    }
+    static inline vec qadd(vec a, vec b) { return vqaddq_s16(a, b); }
+    static inline vec qsub(vec a, vec b) { return vqsubq_s16(a, b); }
+    static inline vec shadd(vec a, vec b) { return vhaddq_s16(a, b); }
+    static inline vec shsub(vec a, vec b) { return vhsubq_s16(a, b); }
+    static inline vec shr1(vec a) { return vshrq_n_s16(a, 1); }
+    static inline vec shr2(vec a) { return vshrq_n_s16(a, 2); }
+    // low half of each word from lo, high half from hi
+    static inline vec halves(vec lo, vec hi) {
+        return vbslq_s16(vreinterpretq_u16_u32(vdupq_n_u32(0xFFFF0000)), hi, lo);
+    }
+    static inline vec qasx(vec a, vec b) {
+        b = vrev32q_s16(b);
+        return halves(vqsubq_s16(a, b), vqaddq_s16(a, b));
+    }
+    static inline vec qsax(vec a, vec b) {
+        b = vrev32q_s16(b);
+        return halves(vqaddq_s16(a, b), vqsubq_s16(a, b));
+    }
+    static inline vec shasx(vec a, vec b) {
+        b = vrev32q_s16(b);
+        return halves(vhsubq_s16(a, b), vhaddq_s16(a, b));
+    }
+    static inline vec shsax(vec a, vec b) {
+        b = vrev32q_s16(b);
+        return halves(vhaddq_s16(a, b), vhsubq_s16(a, b));
+    }
+    // __SMUAD of each word: both products, then pairwise sums
+    static inline int32x4_t smuad(vec a, vec b) {
+        return vpaddq_s32(vmull_s16(vget_low_s16(a), vget_low_s16(b)), vmull_high_s16(a, b));
+    }
+    static inline vec cmul(vec c, vec cn, vec r) {
+        int32x4_t re = smuad(r, c);
+        int32x4_t im = smuad(vrev32q_s16(r), cn);
+        return vtrn2q_s16(vreinterpretq_s16_s32(re), vreinterpretq_s16_s32(im));
+    }
+    static inline void transpose4(vec *a, vec *b, vec *c, vec *d) {
+        int32x4x2_t ab = vtrnq_s32(vreinterpretq_s32_s16(*a), vreinterpretq_s32_s16(*b));
+        int32x4x2_t cd = vtrnq_s32(vreinterpretq_s32_s16(*c), vreinterpretq_s32_s16(*d));
+        *a = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(ab.val[0]), vget_low_s32(cd.val[0])));
+        *b = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(ab.val[1]), vget_low_s32(cd.val[1])));
+        *c = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(ab.val[0]), vget_high_s32(cd.val[0])));
+        *d = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(ab.val[1]), vget_high_s32(cd.val[1])));
+    }
+};
+
+// two newton steps on 2 lanes, none of them 0, the divisions in doubles
+static inline uint32x2_t sqrt_pair(uint32x2_t in)
+{
+    const uint32x2_t e = vsub_u32(vdup_n_u32(31), vclz_u32(in));
+    uint64x2_t n = vmovl_u32(vset_lane_u32(fft_simd_tab.guess[vget_lane_u32(e, 1)],
+        vdup_n_u32(fft_simd_tab.guess[vget_lane_u32(e, 0)]), 1));
+    const float64x2_t d = vcvtq_f64_u64(vmovl_u32(in));
+    n = vshrq_n_u64(vaddq_u64(vcvtq_u64_f64(vdivq_f64(d, vcvtq_f64_u64(n))), n), 1);
+    n = vshrq_n_u64(vaddq_u64(vcvtq_u64_f64(vdivq_f64(d, vcvtq_f64_u64(n))), n), 1);
+    return vmovn_u64(n);
+}
+
+static void magnitudes_neon(const int16_t *buf, int16_t *output)
+{
+    const int32_t *w = (const int32_t *)buf;
+    const int32_t *index = fft_simd_tab.binindex;
+
+    for (int i = 0; i < 512; i += 4) {
+        int32_t words[4] = { w[index[i]], w[index[i+1]], w[index[i+2]], w[index[i+3]] };
+        int16x8_t t = vreinterpretq_s16_s32(vld1q_s32(words));
+        uint32x4_t magsq = vreinterpretq_u32_s32(fft_simd_neon::smuad(t, t));
+        uint32x4_t in = vmaxq_u32(magsq, vdupq_n_u32(1));
+        uint32x4_t mag = vcombine_u32(sqrt_pair(vget_low_u32(in)), sqrt_pair(vget_high_u32(in)));
+        mag = vbicq_u32(mag, vceqq_u32(magsq, vdupq_n_u32(0)));
+        vst1_s16(output + i, vreinterpret_s16_u16(vmovn_u32(mag)));
+    }
+}
+
+extern const fft_simd_kernel fft_simd_kernel_neon = {
+    "neon",
+    fft_simd_fft<fft_simd_neon, fft_simd_neon>,
+    magnitudes_neon
+};
@@ -0,0 +1,34 @@
+// built with -msse4.1
+#include "fft_simd_x86.h"
+
+// two newton steps on lanes 0 and 1 of in, none of them 0
+static inline __m128i sqrt_pair(__m128i in)
+{
+    __m128d d = _mm_add_pd(_mm_cvtepi32_pd(_mm_xor_si128(in, _mm_set1_epi32(0x80000000))), _mm_set1_pd(2147483648.0));
+    __m128i e = _mm_sub_epi64(_mm_srli_epi64(_mm_castpd_si128(d), 52), _mm_set1_epi64x(1023));
+    __m128i n = _mm_setr_epi32(fft_simd_tab.guess[_mm_cvtsi128_si32(e)], fft_simd_tab.guess[_mm_extract_epi32(e, 2)], 0, 0);
+    n = _mm_srli_epi32(_mm_add_epi32(_mm_cvttpd_epi32(_mm_div_pd(d, _mm_cvtepi32_pd(n))), n), 1);
+    n = _mm_srli_epi32(_mm_add_epi32(_mm_cvttpd_epi32(_mm_div_pd(d, _mm_cvtepi32_pd(n))), n), 1);
+    return n;
+}
+
+static void magnitudes_sse41(const int16_t *buf, int16_t *output)
+{
+    const int32_t *w = (const int32_t *)buf;
+    const int32_t *index = fft_simd_tab.binindex;
+
+    for (int i = 0; i < 512; i += 4) {
+        __m128i t = _mm_setr_epi32(w[index[i]], w[index[i+1]], w[index[i+2]], w[index[i+3]]);
+        __m128i magsq = _mm_madd_epi16(t, t);
+        __m128i in = _mm_max_epu32(magsq, _mm_set1_epi32(1));
+        __m128i mag = _mm_unpacklo_epi64(sqrt_pair(in), sqrt_pair(_mm_srli_si128(in, 8)));
+        mag = _mm_andnot_si128(_mm_cmpeq_epi32(magsq, _mm_setzero_si128()), mag);
+        _mm_storel_epi64((__m128i *)(output + i), _mm_packus_epi32(mag, mag));
+    }
+}
+
+extern const fft_simd_kernel fft_simd_kernel_sse41 = {
+    "sse4.1",
+    fft_simd_fft<fft_simd_sse41, fft_simd_sse41>,
+    magnitudes_sse41
+};
@@ -0,0 +1,132 @@
+// SSE4.1 and AVX2 traits for fft_simd_kernel.h and the magnitude loop.
+// The square root keeps sqrt_uint32_approx()'s two newton steps, with the
+// divisions done in doubles, exact for these operands: a quotient that is
+// not whole is at least 1/65535 away from one, far more than a double's
+// rounding error below 2^32.
+#ifndef fft_simd_x86_h_
+#define fft_simd_x86_h_
+
+#include "fft_simd_kernel.h"
+#include <immintrin.h>
+
+struct fft_simd_sse41 {
+    typedef __m128i vec;
+    enum { words = 4 };
+    static inline vec load(const int32_t *p) {
+        return _mm_loadu_si128((const __m128i *)p);
+    }
+    static inline void store(int32_t *p, vec v) {
+        _mm_storeu_si128((__m128i *)p, v);
+    }
+    static inline vec qadd(vec a, vec b) { return _mm_adds_epi16(a, b); }
+    static inline vec qsub(vec a, vec b) { return _mm_subs_epi16(a, b); }
+    // (a & b) + ((a ^ b) >> 1) is floor((a + b) / 2) without a 17th bit
+    static inline vec shadd(vec a, vec b) {
+        return _mm_add_epi16(_mm_and_si128(a, b), _mm_srai_epi16(_mm_xor_si128(a, b), 1));
+    }
+    // (a >> 1) - (b >> 1) - (~a & b & 1) is floor((a - b) / 2)
+    static inline vec shsub(vec a, vec b) {
+        vec borrow = _mm_and_si128(_mm_andnot_si128(a, b), _mm_set1_epi16(1));
+        return _mm_sub_epi16(_mm_sub_epi16(_mm_srai_epi16(a, 1), _mm_srai_epi16(b, 1)), borrow);
+    }
+    static inline vec shr1(vec a) { return _mm_srai_epi16(a, 1); }
+    static inline vec shr2(vec a) { return _mm_srai_epi16(a, 2); }
+    // low half of each word from lo, high half from hi
+    static inline vec halves(vec lo, vec hi) { return _mm_blend_epi16(lo, hi, 0xAA); }
+    static inline vec swap(vec a) {
+        return _mm_shuffle_epi8(a, _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+    }
+    static inline vec qasx(vec a, vec b) {
+        b = swap(b);
+        return halves(_mm_subs_epi16(a, b), _mm_adds_epi16(a, b));
+    }
+    static inline vec qsax(vec a, vec b) {
+        b = swap(b);
+        return halves(_mm_adds_epi16(a, b), _mm_subs_epi16(a, b));
+    }
+    static inline vec shasx(vec a, vec b) {
+        b = swap(b);
+        return halves(shsub(a, b), shadd(a, b));
+    }
+    static inline vec shsax(vec a, vec b) {
+        b = swap(b);
+        return halves(shadd(a, b), shsub(a, b));
+    }
+    // pmaddwd is __SMUAD, wrap-around included, and with the sine
+    // negated on the swapped word it is __SMUSDX
+    static inline vec cmul(vec c, vec cn, vec r) {
+        vec re = _mm_madd_epi16(r, c);
+        vec im = _mm_madd_epi16(swap(r), cn);
+        return halves(_mm_srli_epi32(re, 16), im);
+    }
+    static inline void transpose4(vec *a, vec *b, vec *c, vec *d) {
+        vec t0 = _mm_unpacklo_epi32(*a, *b), t1 = _mm_unpacklo_epi32(*c, *d);
+        vec t2 = _mm_unpackhi_epi32(*a, *b), t3 = _mm_unpackhi_epi32(*c, *d);
+        *a = _mm_unpacklo_epi64(t0, t1);
+        *b = _mm_unpackhi_epi64(t0, t1);
+        *c = _mm_unpacklo_epi64(t2, t3);
+        *d = _mm_unpackhi_epi64(t2, t3);
+    }
+};
+
+#ifdef __AVX2__
+struct fft_simd_avx2 {
+    typedef __m256i vec;
+    enum { words = 8 };
+    static inline vec load(const int32_t *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static inline void store(int32_t *p, vec v) {
+        _mm256_storeu_si256((__m256i *)p, v);
+    }
+    static inline vec qadd(vec a, vec b) { return _mm256_adds_epi16(a, b); }
+    static inline vec qsub(vec a, vec b) { return _mm256_subs_epi16(a, b); }
+    static inline vec shadd(vec a, vec b) {
+        return _mm256_add_epi16(_mm256_and_si256(a, b), _mm256_srai_epi16(_mm256_xor_si256(a, b), 1));
+    }
+    static inline vec shsub(vec a, vec b) {
+        vec borrow = _mm256_and_si256(_mm256_andnot_si256(a, b), _mm256_set1_epi16(1));
+        return _mm256_sub_epi16(_mm256_sub_epi16(_mm256_srai_epi16(a, 1), _mm256_srai_epi16(b, 1)), borrow);
+    }
+    static inline vec shr1(vec a) { return _mm256_srai_epi16(a, 1); }
+    static inline vec shr2(vec a) { return _mm256_srai_epi16(a, 2); }
+    static inline vec halves(vec lo, vec hi) { return _mm256_blend_epi16(lo, hi, 0xAA); }
+    static inline vec swap(vec a) {
+        return _mm256_shuffle_epi8(a, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+            2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+    }
+    static inline vec qasx(vec a, vec b) {
+        b = swap(b);
+        return halves(_mm256_subs_epi16(a, b), _mm256_adds_epi16(a, b));
+    }
+    static inline vec qsax(vec a, vec b) {
+        b = swap(b);
+        return halves(_mm256_adds_epi16(a, b), _mm256_subs_epi16(a, b));
+    }
+    static inline vec shasx(vec a, vec b) {
+        b = swap(b);
+        return halves(shsub(a, b), shadd(a, b));
+    }
+    static inline vec shsax(vec a, vec b) {
+        b = swap(b);
+        return halves(shadd(a, b), shsub(a, b));
+    }
+    static inline vec cmul(vec c, vec cn, vec r) {
+        vec re = _mm256_madd_epi16(r, c);
+        vec im = _mm256_madd_epi16(swap(r), cn);
+        return halves(_mm256_srli_epi32(re, 16), im);
+    }
+    // two 4x4 transposes, one per 128 bit lane, the butterflies end up
+    // in a different order across the vectors, but come back in place
+    static inline void transpose4(vec *a, vec *b, vec *c, vec *d) {
+        vec t0 = _mm256_unpacklo_epi32(*a, *b), t1 = _mm256_unpacklo_epi32(*c, *d);
+        vec t2 = _mm256_unpackhi_epi32(*a, *b), t3 = _mm256_unpackhi_epi32(*c, *d);
+        *a = _mm256_unpacklo_epi64(t0, t1);
+        *b = _mm256_unpackhi_epi64(t0, t1);
+        *c = _mm256_unpacklo_epi64(t2, t3);
+        *d = _mm256_unpackhi_epi64(t2, t3);
+    }
+};
+#endif
+
+#endif
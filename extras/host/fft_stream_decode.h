@@ -0,0 +1,196 @@
+// Receiving end of FFTStream (fft_stream.h). Bytes go in as they arrive
+// from the port, in any sized pieces; frames come out once their packet
+// is complete and its crc checks. After a bad packet the decoder looks for
+// the next sync in what it already holds, and skips delta packets until a
+// keyframe, since their reference was lost.
+#ifndef fft_stream_decode_h_
+#define fft_stream_decode_h_
+
+#include "fft_stream.h"
+
+class FFTStreamDecoder
+{
+public:
+    FFTStreamDecoder() : held(0), ready(false), havekey(false), first(true), lastframe(0),
+    curflags(0), curcount(0), curframe(0), errorcount(0), skipcount(0), missingcount(0) { }
+    // Takes bytes until a frame is complete or data runs out, returns how
+    // many it took. When available() is true read the frame, then call
+    // feed() again with the rest, which may be 0 bytes.
+    size_t feed(const uint8_t *data, size_t len) {
+        ready = false;
+        if (process()) return 0;
+        size_t n = 0;
+        while (n < len) {
+            buffer[held++] = data[n++];
+            if (process()) break;
+        }
+        return n;
+    }
+    bool available(void) {
+        return ready;
+    }
+    // the last frame: its FFT_STREAM_ flags, number and values
+    uint8_t flags(void) {
+        return curflags;
+    }
+    uint16_t count(void) {
+        return curcount;
+    }
+    uint32_t frame(void) {
+        return curframe;
+    }
+    const int16_t * values(void) {
+        return cur.bins;
+    }
+    const uint32_t * bands(void) {
+        return cur.bands;
+    }
+    // packets that failed their checks
+    uint32_t errors(void) {
+        return errorcount;
+    }
+    // delta packets thrown away while waiting for a keyframe
+    uint32_t skipped(void) {
+        return skipcount;
+    }
+    // gaps in the frame numbers: dropped by the sender, lost or skipped
+    uint32_t missing(void) {
+        return missingcount;
+    }
+private:
+    enum { NEED_MORE, BAD, COMPLETE };
+    static uint16_t get16(const uint8_t *p) {
+        return p[0] | (p[1] << 8);
+    }
+    static uint32_t get32(const uint8_t *p) {
+        return get16(p) | ((uint32_t)get16(p + 2) << 16);
+    }
+    static uint16_t crc16(const uint8_t *p, uint32_t len) {
+        uint16_t crc = 0xFFFF;
+        while (len--) {
+            crc ^= *p++ << 8;
+            for (int i=0; i < 8; i++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        return crc;
+    }
+    // checks what is held, decodes a complete packet, drops a bad one
+    bool process(void) {
+        while (held) {
+            int status = check();
+            if (status == NEED_MORE) return false;
+            if (status == COMPLETE) {
+                uint32_t total = FFT_STREAM_HEADER + get16(buffer + 9) + 2;
+                bool got = accept();
+                held -= total;
+                memmove(buffer, buffer + total, held);
+                if (got) return ready = true;
+                continue;
+            }
+            // resume at the next sync byte after the bad packet's, a
+            // stray byte before a sync is not counted as a packet
+            if (held >= 2 && buffer[0] == 0xA5 && buffer[1] == 0x5A) errorcount++;
+            havekey = false;
+            uint32_t i = 1;
+            while (i < held && buffer[i] != 0xA5) i++;
+            held -= i;
+            memmove(buffer, buffer + i, held);
+        }
+        return false;
+    }
+    int check(void) {
+        if (buffer[0] != 0xA5) return BAD;
+        if (held < 2) return NEED_MORE;
+        if (buffer[1] != 0x5A) return BAD;
+        if (held < FFT_STREAM_HEADER) return NEED_MORE;
+        const uint8_t f = buffer[2];
+        const uint16_t n = get16(buffer + 3), len = get16(buffer + 9);
+        if (f & ~(FFT_STREAM_DELTA | FFT_STREAM_KEYFRAME | FFT_STREAM_DB | FFT_STREAM_BANDS)) return BAD;
+        if (n > ((f & FFT_STREAM_BANDS) ? FFT_MAX_BANDS : 512)) return BAD;
+        if (len > FFT_STREAM_BUFFER_SIZE - FFT_STREAM_HEADER - 2) return BAD;
+        if (held < FFT_STREAM_HEADER + len + 2u) return NEED_MORE;
+        if (crc16(buffer + 2, FFT_STREAM_HEADER - 2 + len) != get16(buffer + FFT_STREAM_HEADER + len)) return BAD;
+        return decode(f, n, buffer + FFT_STREAM_HEADER, len) ? COMPLETE : BAD;
+    }
+    // payload into next, or the differences into delta, true if it holds
+    // exactly n values
+    bool decode(uint8_t f, uint16_t n, const uint8_t *p, uint16_t len) {
+        const bool wide = f & FFT_STREAM_BANDS;
+        const uint8_t *end = p + len;
+        if (!(f & FFT_STREAM_DELTA)) {
+            if (len != n * (wide ? 4 : 2)) return false;
+            for (int i=0; i < n; i++) {
+                if (wide) next.bands[i] = get32(p + i * 4);
+                else next.bins[i] = get16(p + i * 2);
+            }
+            return true;
+        }
+        int i = 0;
+        while (p < end) {
+            if (*p == 0) {
+                if (end - p < 2 || i + p[1] + 1 > n) return false;
+                for (int r = p[1]; r >= 0; r--) delta[i++] = 0;
+                p += 2;
+                continue;
+            }
+            uint32_t v = 0;
+            int shift = 0;
+            do {
+                if (p == end || shift > 28 || i == n) return false;
+                v |= (uint32_t)(*p & 0x7F) << shift;
+                shift += 7;
+            } while (*p++ & 0x80);
+            delta[i++] = (int32_t)((v >> 1) ^ -(v & 1));
+        }
+        return i == n;
+    }
+    // makes next the current frame unless it is a delta without a reference
+    bool accept(void) {
+        const uint8_t f = buffer[2];
+        const uint16_t n = get16(buffer + 3);
+        const uint32_t number = get32(buffer + 5);
+        const bool wide = f & FFT_STREAM_BANDS;
+        if (!first && number - lastframe > 1) missingcount += number - lastframe - 1;
+        first = false;
+        lastframe = number;
+        if ((f & FFT_STREAM_DELTA) && !(f & FFT_STREAM_KEYFRAME)) {
+            if (!havekey || n != curcount || (f & (FFT_STREAM_DB | FFT_STREAM_BANDS)) !=
+                (curflags & (FFT_STREAM_DB | FFT_STREAM_BANDS))) {
+                skipcount++;
+                havekey = false;
+                return false;
+            }
+        }
+        for (int i=0; i < n; i++) {
+            if (!(f & FFT_STREAM_DELTA)) {
+                if (wide) cur.bands[i] = next.bands[i];
+                else cur.bins[i] = next.bins[i];
+            } else if (f & FFT_STREAM_KEYFRAME) {
+                if (wide) cur.bands[i] = delta[i];
+                else cur.bins[i] = delta[i];
+            } else {
+                if (wide) cur.bands[i] += delta[i];
+                else cur.bins[i] += delta[i];
+            }
+        }
+        havekey = havekey || (f & FFT_STREAM_KEYFRAME) || !(f & FFT_STREAM_DELTA);
+        curflags = f;
+        curcount = n;
+        curframe = number;
+        return true;
+    }
+    uint8_t buffer[FFT_STREAM_BUFFER_SIZE];
+    uint32_t held;
+    bool ready, havekey, first;
+    uint32_t lastframe;
+    union {
+        int16_t bins[512];
+        uint32_t bands[FFT_MAX_BANDS];
+    } cur, next;
+    int32_t delta[512];
+    uint8_t curflags;
+    uint16_t curcount;
+    uint32_t curframe;
+    uint32_t errorcount, skipcount, missingcount;
+};
+
+#endif
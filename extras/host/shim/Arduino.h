@@ -0,0 +1,44 @@
+// Host stand-in for the parts of the Teensy core the analyzer uses, so the
+// library sources build unchanged with gcc or clang on a desktop machine.
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+// the host runs one update() at a time per analyzer, nothing to mask
+#define __disable_irq() do {} while (0)
+#define __enable_irq() do {} while (0)
+
+// the cpu cycle counter reads a free running host counter
+#ifdef __cplusplus
+extern "C" {
+#endif
+uint32_t host_cycle_count(void);
+#ifdef __cplusplus
+}
+#endif
+#define ARM_DWT_CYCCNT host_cycle_count()
+
+#ifdef __cplusplus
+// the byte sink Serial and the other ports derive from
+class Print
+{
+public:
+    virtual ~Print() { }
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t n = 0;
+        while (size-- && write(*buffer++)) n++;
+        return n;
+    }
+    virtual int availableForWrite(void) {
+        return 0;
+    }
+};
+#endif
+
+#endif
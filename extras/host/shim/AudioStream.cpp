@@ -0,0 +1,38 @@
+#include "AudioStream.h"
+#include "EventResponder.h"
+#include <time.h>
+
+static int allocatedblocks = 0;
+
+audio_block_t * AudioStream::allocate(void)
+{
+    audio_block_t *block = (audio_block_t *)calloc(1, sizeof(audio_block_t));
+    if (!block) return NULL;
+    block->ref_count = 1;
+    __atomic_add_fetch(&allocatedblocks, 1, __ATOMIC_RELAXED);
+    return block;
+}
+
+void AudioStream::release(audio_block_t *block)
+{
+    if (!block) return;
+    if (__atomic_sub_fetch(&block->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(block);
+        __atomic_sub_fetch(&allocatedblocks, 1, __ATOMIC_RELAXED);
+    }
+}
+
+int AudioStream::allocated(void)
+{
+    return __atomic_load_n(&allocatedblocks, __ATOMIC_RELAXED);
+}
+
+// nanoseconds stand in for cycles, they wrap the same way
+extern "C" uint32_t host_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+EventResponder *EventResponder::list = NULL;
@@ -0,0 +1,51 @@
+// Host stand-in for the Teensy AudioStream base class. There is no audio
+// interrupt, the caller hands a block to an object with hostInject() and
+// then calls its update(), one block per call like the audio library does.
+#ifndef AudioStream_h
+#define AudioStream_h
+
+#include "Arduino.h"
+
+#define AUDIO_BLOCK_SAMPLES 128
+#define AUDIO_SAMPLE_RATE_EXACT 44117.64706f
+
+#define AudioNoInterrupts() do {} while (0)
+#define AudioInterrupts() do {} while (0)
+
+typedef struct audio_block_struct {
+    uint8_t  ref_count;
+    uint8_t  reserved1;
+    uint16_t memory_pool_index;
+    int16_t  data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+class AudioStream
+{
+public:
+    AudioStream(unsigned char ninput, audio_block_t **iqueue) : inputQueue(iqueue), num_inputs(ninput) {
+        for (int i=0; i < ninput; i++) iqueue[i] = NULL;
+    }
+    virtual ~AudioStream() {}
+    virtual void update(void) = 0;
+    float processorUsage(void) { return 0; }
+    float processorUsageMax(void) { return 0; }
+    static audio_block_t * allocate(void);
+    static void release(audio_block_t * block);
+    // blocks currently allocated, to catch leaks
+    static int allocated(void);
+    // queue a block on input 0, update() receives it, NULL is no block
+    void hostInject(audio_block_t *block) {
+        inputQueue[0] = block;
+    }
+protected:
+    audio_block_t * receiveReadOnly(unsigned int index = 0) {
+        if (index >= num_inputs) return NULL;
+        audio_block_t *in = inputQueue[index];
+        inputQueue[index] = NULL;
+        return in;
+    }
+    audio_block_t **inputQueue;
+    unsigned char num_inputs;
+};
+
+#endif
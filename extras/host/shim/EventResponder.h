@@ -0,0 +1,58 @@
+// Host stand-in for the Teensy EventResponder. Immediate and interrupt
+// events run at once inside triggerEvent(), yield events wait for yield().
+#ifndef EventResponder_h
+#define EventResponder_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+class EventResponder;
+typedef EventResponder& EventResponderRef;
+typedef void (*EventResponderFunction)(EventResponderRef);
+
+class EventResponder
+{
+public:
+    EventResponder() : fn(NULL), ctx(NULL), polled(false), pending(false), next(NULL) {}
+    void attachImmediate(EventResponderFunction f) {
+        fn = f;
+        polled = false;
+    }
+    void attachInterrupt(EventResponderFunction f, uint8_t priority = 128) {
+        fn = f;
+        polled = false;
+    }
+    void attach(EventResponderFunction f, uint8_t priority = 128) {
+        fn = f;
+        polled = true;
+        for (EventResponder *e = list; e; e = e->next) if (e == this) return;
+        next = list;
+        list = this;
+    }
+    void setContext(void *c) { ctx = c; }
+    void *getContext() { return ctx; }
+    void triggerEvent(int status = 0, void *data = NULL) {
+        if (!fn) return;
+        if (polled) pending = true;
+        else fn(*this);
+    }
+    static void runFromYield() {
+        for (EventResponder *e = list; e; e = e->next) {
+            if (e->pending) {
+                e->pending = false;
+                e->fn(*e);
+            }
+        }
+    }
+private:
+    EventResponderFunction fn;
+    void *ctx;
+    bool polled;
+    volatile bool pending;
+    EventResponder *next;
+    static EventResponder *list;
+};
+
+static inline void yield(void) { EventResponder::runFromYield(); }
+
+#endif
@@ -0,0 +1,59 @@
+// Host stand-in for the CMSIS-DSP init, bit reversal and twiddle table.
+// The twiddles are generated the way CMSIS documents them, round(x * 2^15)
+// saturated to q15, the first three quarters of a 4096 point circle.
+#include "arm_math.h"
+#include <math.h>
+
+static q15_t twiddle[6144];
+extern const q15_t twiddleCoef_4096_q15[6144] __attribute__ ((alias ("twiddle")));
+const uint16_t armBitRevTable[1024] = { 0 };
+
+static q15_t twiddle_q15(double x)
+{
+    long v = lround(x * 32768.0);
+    if (v > 32767) v = 32767;
+    if (v < -32768) v = -32768;
+    return (q15_t)v;
+}
+
+// ahead of C++ static constructors, an analyzer's constructor reads them
+static void twiddle_init(void) __attribute__ ((constructor (101)));
+static void twiddle_init(void)
+{
+    for (int i = 0; i < 3072; i++) {
+        twiddle[2*i] = twiddle_q15(cos(2.0 * M_PI * i / 4096.0));
+        twiddle[2*i+1] = twiddle_q15(sin(2.0 * M_PI * i / 4096.0));
+    }
+}
+
+arm_status arm_cfft_radix4_init_q15(arm_cfft_radix4_instance_q15 * S, uint16_t fftLen, uint8_t ifftFlag, uint8_t bitReverseFlag)
+{
+    if (fftLen != 16 && fftLen != 64 && fftLen != 256 && fftLen != 1024) {
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    S->fftLen = fftLen;
+    S->ifftFlag = ifftFlag;
+    S->bitReverseFlag = bitReverseFlag;
+    S->pTwiddle = (q15_t *)twiddleCoef_4096_q15;
+    S->twidCoefModifier = 4096u / fftLen;
+    S->bitRevFactor = 4096u / fftLen;
+    // the same offsets into the 4096 point table as CMSIS, [3] for 1024
+    S->pBitRevTable = (uint16_t *)&armBitRevTable[4096u / fftLen - 1u];
+    return ARM_MATH_SUCCESS;
+}
+
+// the same permutation as the CMSIS table walk, computed directly
+void arm_bitreversal_q15(q15_t * pSrc, uint32_t fftLen, uint16_t bitRevFactor, uint16_t * pBitRevTab)
+{
+    int32_t *p = (int32_t *)pSrc;
+    int bits = 0;
+    while ((1u << bits) < fftLen) bits++;
+    for (uint32_t i = 0; i < fftLen; i++) {
+        uint32_t r = __RBIT(i) >> (32 - bits);
+        if (r > i) {
+            int32_t t = p[i];
+            p[i] = p[r];
+            p[r] = t;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+// Host stand-in for the CMSIS-DSP pieces fft.c uses: the q15 types, the
+// radix-4 instance and the Cortex-M4 SIMD intrinsics, each written out one
+// lane at a time with the same saturation and wrap-around as the hardware.
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+typedef enum {
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1
+} arm_status;
+
+typedef struct {
+    uint16_t fftLen;
+    uint8_t ifftFlag;
+    uint8_t bitReverseFlag;
+    q15_t *pTwiddle;
+    uint16_t *pBitRevTable;
+    uint16_t twidCoefModifier;
+    uint16_t bitRevFactor;
+} arm_cfft_radix4_instance_q15;
+
+#define __SIMD32_TYPE int32_t
+#define __SIMD32(addr)  (*(__SIMD32_TYPE **) & (addr))
+#define _SIMD32_OFFSET(addr)  (*(__SIMD32_TYPE * )  (addr))
+#define __INLINE static inline
+
+#define HOST_LO(x) ((int32_t)(int16_t)((x) & 0xFFFF))
+#define HOST_HI(x) ((int32_t)(int16_t)(((uint32_t)(x)) >> 16))
+#define HOST_PK(h,l) ((int32_t)((((uint32_t)(h)) << 16) | (((uint32_t)(l)) & 0xFFFF)))
+
+static inline int32_t host_sat16(int32_t x) {
+    return x > 32767 ? 32767 : (x < -32768 ? -32768 : x);
+}
+static inline int32_t __QADD16(int32_t a, int32_t b) {
+    return HOST_PK(host_sat16(HOST_HI(a) + HOST_HI(b)), host_sat16(HOST_LO(a) + HOST_LO(b)));
+}
+static inline int32_t __QSUB16(int32_t a, int32_t b) {
+    return HOST_PK(host_sat16(HOST_HI(a) - HOST_HI(b)), host_sat16(HOST_LO(a) - HOST_LO(b)));
+}
+static inline int32_t __SHADD16(int32_t a, int32_t b) {
+    return HOST_PK((HOST_HI(a) + HOST_HI(b)) >> 1, (HOST_LO(a) + HOST_LO(b)) >> 1);
+}
+static inline int32_t __SHSUB16(int32_t a, int32_t b) {
+    return HOST_PK((HOST_HI(a) - HOST_HI(b)) >> 1, (HOST_LO(a) - HOST_LO(b)) >> 1);
+}
+static inline int32_t __QASX(int32_t a, int32_t b) {
+    return HOST_PK(host_sat16(HOST_HI(a) + HOST_LO(b)), host_sat16(HOST_LO(a) - HOST_HI(b)));
+}
+static inline int32_t __QSAX(int32_t a, int32_t b) {
+    return HOST_PK(host_sat16(HOST_HI(a) - HOST_LO(b)), host_sat16(HOST_LO(a) + HOST_HI(b)));
+}
+static inline int32_t __SHASX(int32_t a, int32_t b) {
+    return HOST_PK((HOST_HI(a) + HOST_LO(b)) >> 1, (HOST_LO(a) - HOST_HI(b)) >> 1);
+}
+static inline int32_t __SHSAX(int32_t a, int32_t b) {
+    return HOST_PK((HOST_HI(a) - HOST_LO(b)) >> 1, (HOST_LO(a) + HOST_HI(b)) >> 1);
+}
+static inline int32_t __SMUAD(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)(HOST_LO(a) * HOST_LO(b)) + (uint32_t)(HOST_HI(a) * HOST_HI(b)));
+}
+static inline int32_t __SMUADX(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)(HOST_LO(a) * HOST_HI(b)) + (uint32_t)(HOST_HI(a) * HOST_LO(b)));
+}
+static inline int32_t __SMUSD(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)(HOST_LO(a) * HOST_LO(b)) - (uint32_t)(HOST_HI(a) * HOST_HI(b)));
+}
+static inline int32_t __SMUSDX(int32_t a, int32_t b) {
+    return (int32_t)((uint32_t)(HOST_LO(a) * HOST_HI(b)) - (uint32_t)(HOST_HI(a) * HOST_LO(b)));
+}
+static inline int32_t __SMLAD(int32_t a, int32_t b, int32_t c) {
+    return (int32_t)((uint32_t)__SMUAD(a, b) + (uint32_t)c);
+}
+static inline int32_t __PKHBT(int32_t a, int32_t b, int s) {
+    return (int32_t)(((uint32_t)a & 0xFFFF) | (((uint32_t)b << s) & 0xFFFF0000));
+}
+static inline int32_t __PKHTB(int32_t a, int32_t b, int s) {
+    return (int32_t)(((uint32_t)a & 0xFFFF0000) | (((uint32_t)(b >> s)) & 0xFFFF));
+}
+static inline uint32_t __RBIT(uint32_t v) {
+    v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+    v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+    return __builtin_bswap32(v);
+}
+static inline uint32_t __CLZ(uint32_t v) {
+    return v ? __builtin_clz(v) : 32;
+}
+static inline int32_t __SSAT(int32_t v, int bits) {
+    int32_t max = (1 << (bits - 1)) - 1, min = -(1 << (bits - 1));
+    return v > max ? max : (v < min ? min : v);
+}
+
+// arm_common_tables.c
+extern const q15_t twiddleCoef_4096_q15[6144];
+extern const uint16_t armBitRevTable[1024];
+
+arm_status arm_cfft_radix4_init_q15(arm_cfft_radix4_instance_q15 * S, uint16_t fftLen, uint8_t ifftFlag, uint8_t bitReverseFlag);
+void arm_bitreversal_q15(q15_t * pSrc, uint32_t fftLen, uint16_t bitRevFactor, uint16_t * pBitRevTab);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,16 @@
+// Host stand-in for the Teensy audio library's data_waveforms.c, only the
+// sine table the analyzer uses.
+#include <stdint.h>
+#include <math.h>
+
+static int16_t sine_table[257];
+extern const int16_t AudioWaveformSine[257] __attribute__ ((alias ("sine_table")));
+
+// ahead of C++ static constructors, like the flash tables on the device
+static void sine_init(void) __attribute__ ((constructor (101)));
+static void sine_init(void)
+{
+    for (int i = 0; i < 257; i++) {
+        sine_table[i] = (int16_t)lround(sin(2.0 * M_PI * i / 256.0) * 32767.0);
+    }
+}
@@ -0,0 +1,52 @@
+// Host stand-in for the Teensy audio library's data_windows.c, the same
+// windows computed from their definitions at startup. Build with
+// AUDIO_LIB= pointing at the audio library to use the device tables.
+#include <stdint.h>
+#include <math.h>
+
+#define WINDOW_TABLES \
+    X(Hanning) X(Bartlett) X(Blackman) X(Flattop) X(BlackmanHarris) \
+    X(Nuttall) X(BlackmanNuttall) X(Welch) X(Hamming) X(Cosine) X(Tukey)
+
+#define X(name) static int16_t name##_table[1024] __attribute__ ((aligned (4))); \
+    extern const int16_t AudioWindow##name##1024[1024] __attribute__ ((alias (#name "_table")));
+WINDOW_TABLES
+#undef X
+
+static double cosine_sum(double x, double a0, double a1, double a2, double a3)
+{
+    return a0 - a1 * cos(2.0 * M_PI * x) + a2 * cos(4.0 * M_PI * x) - a3 * cos(6.0 * M_PI * x);
+}
+
+static int16_t window_q15(double w)
+{
+    long v = lround(w * 32767.0);
+    if (v > 32767) v = 32767;
+    if (v < -32768) v = -32768;
+    return (int16_t)v;
+}
+
+// ahead of C++ static constructors, like the flash tables on the device
+static void window_init(void) __attribute__ ((constructor (101)));
+static void window_init(void)
+{
+    for (int i = 0; i < 1024; i++) {
+        const double x = i / 1023.0, t = 2.0 * x - 1.0;
+        Hanning_table[i] = window_q15(cosine_sum(x, 0.5, 0.5, 0, 0));
+        Bartlett_table[i] = window_q15(1.0 - fabs(t));
+        Blackman_table[i] = window_q15(cosine_sum(x, 0.42, 0.5, 0.08, 0));
+        Flattop_table[i] = window_q15(cosine_sum(x, 0.21557895, 0.41663158, 0.277263158, 0.083578947)
+            + 0.006947368 * cos(8.0 * M_PI * x));
+        BlackmanHarris_table[i] = window_q15(cosine_sum(x, 0.35875, 0.48829, 0.14128, 0.01168));
+        Nuttall_table[i] = window_q15(cosine_sum(x, 0.355768, 0.487396, 0.144232, 0.012604));
+        BlackmanNuttall_table[i] = window_q15(cosine_sum(x, 0.3635819, 0.4891775, 0.1365995, 0.0106411));
+        Welch_table[i] = window_q15(1.0 - t * t);
+        Hamming_table[i] = window_q15(cosine_sum(x, 0.54, 0.46, 0, 0));
+        Cosine_table[i] = window_q15(sin(M_PI * x));
+        // Tukey with alpha = 0.5, flat across the middle half
+        double tukey = 1.0;
+        if (x < 0.25) tukey = 0.5 - 0.5 * cos(4.0 * M_PI * x);
+        else if (x > 0.75) tukey = 0.5 - 0.5 * cos(4.0 * M_PI * (1.0 - x));
+        Tukey_table[i] = window_q15(tukey);
+    }
+}
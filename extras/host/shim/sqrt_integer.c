@@ -0,0 +1,12 @@
+// Host stand-in for the Teensy audio library's utility/sqrt_integer.c, the
+// guess for an input with n leading zeros is 2^((31 - n) / 2 + 1/4)
+// rounded up, the geometric middle of the square roots it covers.
+#include <stdint.h>
+
+const uint16_t sqrt_integer_guess_table[33] = {
+55109, 38968, 27555, 19484, 13778, 9742, 6889, 4871,
+ 3445,  2436,  1723,  1218,   862,  609,  431,  305,
+  216,   153,   108,    77,    54,   39,   27,   20,
+   14,    10,     7,     5,     4,    3,    2,    2,
+    1
+};
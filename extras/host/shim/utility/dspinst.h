@@ -0,0 +1,39 @@
+// Host stand-in for the Teensy audio library's utility/dspinst.h
+#ifndef dspinst_h_
+#define dspinst_h_
+
+#include <stdint.h>
+
+static inline int32_t signed_saturate_rshift(int32_t val, int bits, int rshift) {
+    int32_t v = val >> rshift, max = (1 << (bits - 1)) - 1, min = -(1 << (bits - 1));
+    return v > max ? max : (v < min ? min : v);
+}
+static inline int32_t multiply_32x32_rshift32(int32_t a, int32_t b) {
+    return ((int64_t)a * b) >> 32;
+}
+static inline int32_t multiply_32x32_rshift32_rounded(int32_t a, int32_t b) {
+    return (((int64_t)a * b) + 0x80000000LL) >> 32;
+}
+static inline int32_t multiply_16bx16b(uint32_t a, uint32_t b) {
+    return (int16_t)a * (int16_t)b;
+}
+static inline int32_t multiply_16bx16t(uint32_t a, uint32_t b) {
+    return (int16_t)a * (int16_t)(b >> 16);
+}
+static inline int32_t multiply_16tx16b(uint32_t a, uint32_t b) {
+    return (int16_t)(a >> 16) * (int16_t)b;
+}
+static inline int32_t multiply_16tx16t(uint32_t a, uint32_t b) {
+    return (int16_t)(a >> 16) * (int16_t)(b >> 16);
+}
+static inline uint32_t multiply_16tx16t_add_16bx16b(uint32_t a, uint32_t b) {
+    return (uint32_t)((int16_t)(a >> 16) * (int16_t)(b >> 16)) + (uint32_t)((int16_t)a * (int16_t)b);
+}
+static inline uint32_t pack_16b_16b(int32_t a, int32_t b) {
+    return ((uint32_t)a << 16) | (b & 0xFFFF);
+}
+static inline uint32_t pack_16t_16b(int32_t a, int32_t b) {
+    return (a & 0xFFFF0000) | (b & 0xFFFF);
+}
+
+#endif
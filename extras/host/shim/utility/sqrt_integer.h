@@ -0,0 +1,26 @@
+// Host stand-in for the Teensy audio library's utility/sqrt_integer.h
+#ifndef sqrt_integer_h_
+#define sqrt_integer_h_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern const uint16_t sqrt_integer_guess_table[33];
+#ifdef __cplusplus
+}
+#endif
+
+// two newton steps from a table guess, 0 gives 0 like the udiv on the M4
+static inline uint32_t sqrt_uint32_approx(uint32_t in) __attribute__((always_inline, unused));
+static inline uint32_t sqrt_uint32_approx(uint32_t in)
+{
+    if (in == 0) return 0;
+    uint32_t n = sqrt_integer_guess_table[__builtin_clz(in)];
+    n = ((in / n) + n) / 2;
+    n = ((in / n) + n) / 2;
+    return n;
+}
+
+#endif
@@ -0,0 +1,34 @@
+// Binary spectrogram written by fft_analyze: one header, then one frame of
+// bins values per hop, all little endian. Frames are int16_t, the raw
+// output[] of the analyzer, or uint32_t band sums with SPECTROGRAM_BANDS.
+#ifndef spectrogram_h_
+#define spectrogram_h_
+
+#include <stdint.h>
+
+#define SPECTROGRAM_MAGIC    0x47505346u  // "FSPG"
+#define SPECTROGRAM_VERSION  1
+
+// header flags
+#define SPECTROGRAM_DB       0x0001  // values are Q8 dB, add dbOffset
+#define SPECTROGRAM_BANDS    0x0002  // values are uint32_t band sums
+#define SPECTROGRAM_RADIX8   0x0004  // radix-8 middle stage
+
+struct spectrogram_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint16_t bins;          // values per frame
+    uint16_t hop;           // samples between frames, frame n starts at n * hop
+    uint32_t sampleRate;    // of the source file
+    uint32_t frames;
+    float scale;            // read() units per value, what read() multiplies by
+    float dbOffset;         // dB of a Q8 value of 0, readDB() adds it
+};
+
+static inline uint32_t spectrogram_frame_bytes(const struct spectrogram_header *h)
+{
+    return h->bins * ((h->flags & SPECTROGRAM_BANDS) ? 4u : 2u);
+}
+
+#endif
@@ -0,0 +1,244 @@
+// Reads the packets FFTStream (fft_stream.h) sends from a serial port and
+// prints one line per frame: its number, flags and values. With -t it
+// tests the stream end to end over a pseudo terminal instead: a thread
+// runs the analyzer and FFTStream on the slave side like a device would,
+// writing only what the port takes without blocking, and every frame
+// decoded on the master side is compared with the one that was sent. -d
+// sends through packet() and packetSent() as a DMA transfer would.
+
+#include "fft_stream.h"
+#include "fft_stream_decode.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// no line editing, echo or newline translation, the packets are binary
+static bool open_raw(int fd)
+{
+    struct termios t;
+    if (tcgetattr(fd, &t) < 0) return false;
+    cfmakeraw(&t);
+    return tcsetattr(fd, TCSANOW, &t) == 0;
+}
+
+static void print_frame(FFTStreamDecoder &dec)
+{
+    const uint8_t f = dec.flags();
+    printf("%u %c%c%c", dec.frame(), (f & FFT_STREAM_KEYFRAME) ? 'k' : '-',
+        (f & FFT_STREAM_DB) ? 'd' : '-', (f & FFT_STREAM_BANDS) ? 'b' : '-');
+    for (int i=0; i < dec.count(); i++) {
+        if (f & FFT_STREAM_BANDS) printf(" %u", dec.bands()[i]);
+        else printf(" %d", dec.values()[i]);
+    }
+    printf("\n");
+}
+
+// the slave side of the pty as a non-blocking Print, corrupting one byte
+// in every corrupt when that is set
+class PtyPrint : public Print
+{
+public:
+    PtyPrint(int f, uint32_t c) : fd(f), corrupt(c), total(0) { }
+    virtual size_t write(uint8_t b) {
+        return write(&b, 1);
+    }
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        uint8_t copy[FFT_STREAM_BUFFER_SIZE];
+        if (size > sizeof(copy)) size = sizeof(copy);
+        memcpy(copy, buffer, size);
+        for (size_t i=0; corrupt && i < size; i++) {
+            if ((total + i) % corrupt == corrupt / 2) copy[i] ^= 0x10;
+        }
+        ssize_t n = ::write(fd, copy, size);
+        if (n <= 0) return 0;
+        total += n;
+        return n;
+    }
+    uint64_t bytes(void) {
+        return total;
+    }
+    // what a USB serial port takes at once
+    virtual int availableForWrite(void) {
+        return 64;
+    }
+private:
+    int fd;
+    uint32_t corrupt;
+    uint64_t total;
+};
+
+struct sent_frames {
+    std::mutex lock;
+    std::map<uint32_t, std::vector<uint32_t> > values;
+    std::atomic<bool> done;
+};
+
+// Sends packet() the way a DMA channel would, a piece each call without
+// update(), and reports the packet done with packetSent(). Returns the
+// bytes left.
+static uint16_t dma_send(FFTStream &stream, Print &port, uint16_t *pos)
+{
+    if (!stream.busy()) return 0;
+    uint16_t n = stream.packetLength() - *pos;
+    if (n > 64) n = 64;
+    *pos += port.write(stream.packet() + *pos, n);
+    if (*pos < stream.packetLength()) return stream.packetLength() - *pos;
+    stream.packetSent();
+    *pos = 0;
+    return 0;
+}
+
+// the device: a chirp with noise, alternating between bins and bands
+static void produce(int fd, uint8_t encoding, uint32_t corrupt, uint32_t blocks, bool dma, sent_frames *sent)
+{
+    PtyPrint port(fd, corrupt);
+    FFTStream stream;
+    AudioAnalyzeFFT1024_Fast fft;
+    stream.begin(port, encoding, 16);
+    fft.bandMapLog(32, 40.0f, 16000.0f);
+    uint32_t seed = 1, n = 0;
+    uint16_t dmapos = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        audio_block_t *block = AudioStream::allocate();
+        for (int i=0; i < AUDIO_BLOCK_SAMPLES; i++, n++) {
+            seed = seed * 1664525u + 1013904223u;
+            double v = 0.5 * sin(2.0 * M_PI * (200.0 + n * 0.02) * n / 44100.0) + ((int32_t)seed >> 20) / 32768.0;
+            block->data[i] = (int16_t)lround(v * 32767.0);
+        }
+        fft.hostInject(block);
+        fft.update();
+        if (fft.available()) {
+            std::vector<uint32_t> v;
+            bool ok;
+            if ((stream.frames() / 64) & 1) {
+                ok = stream.writeBands(fft);
+                v.assign(fft.bandoutput, fft.bandoutput + fft.bands());
+            } else {
+                ok = stream.write(fft);
+                for (int i=0; i < 512; i++) v.push_back((uint16_t)fft.output[i]);
+            }
+            if (ok) {
+                std::lock_guard<std::mutex> guard(sent->lock);
+                sent->values[stream.frames() - 1] = v;
+            }
+        }
+        if (dma) dma_send(stream, port, &dmapos);
+        else stream.update();
+        // about the rate a 44.1 kHz stream calls loop()
+        usleep(100);
+    }
+    while (dma ? dma_send(stream, port, &dmapos) : stream.update()) usleep(100);
+    printf("sent %u frames in %llu bytes, %u dropped while the port was busy\n",
+        stream.frames() - stream.dropped(), (unsigned long long)port.bytes(), stream.dropped());
+    sent->done = true;
+}
+
+static int self_test(uint8_t encoding, uint32_t corrupt, uint32_t blocks, bool dma)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    int slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (slave < 0 || !open_raw(slave) || !open_raw(master)) {
+        perror("pty");
+        return 1;
+    }
+    sent_frames sent;
+    sent.done = false;
+    std::thread device(produce, slave, encoding, corrupt, blocks, dma, &sent);
+
+    FFTStreamDecoder dec;
+    uint32_t decoded = 0, wrong = 0;
+    uint8_t data[4096];
+    while (true) {
+        struct pollfd p = { master, POLLIN, 0 };
+        if (poll(&p, 1, 200) == 0) {
+            if (sent.done) break;
+            continue;
+        }
+        ssize_t len = read(master, data, sizeof(data));
+        if (len <= 0) break;
+        for (ssize_t pos = 0; ; ) {
+            pos += dec.feed(data + pos, len - pos);
+            if (!dec.available()) break;
+            decoded++;
+            std::vector<uint32_t> v;
+            {
+                std::lock_guard<std::mutex> guard(sent.lock);
+                v = sent.values[dec.frame()];
+            }
+            bool same = v.size() == dec.count();
+            for (size_t i=0; same && i < v.size(); i++) {
+                if (dec.flags() & FFT_STREAM_BANDS) same = v[i] == dec.bands()[i];
+                else same = v[i] == (uint16_t)dec.values()[i];
+            }
+            if (!same && wrong++ == 0) fprintf(stderr, "frame %u differs from the one sent\n", dec.frame());
+        }
+    }
+    device.join();
+    close(slave);
+    close(master);
+    printf("decoded %u frames, %u wrong, %u bad packets, %u deltas skipped, %u numbers missing\n",
+        decoded, wrong, dec.errors(), dec.skipped(), dec.missing());
+    if (wrong || decoded == 0) return 1;
+    if (!corrupt && (dec.errors() || decoded != sent.values.size())) return 1;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t encoding = FFT_STREAM_DELTA;
+    uint32_t corrupt = 0, blocks = 4000;
+    bool test = false, dma = false;
+    int c;
+    while ((c = getopt(argc, argv, "tRdc:n:")) != -1) {
+        switch (c) {
+        case 't': test = true; break;
+        case 'd': dma = true; break;
+        case 'R': encoding = FFT_STREAM_RAW; break;
+        case 'c': corrupt = strtoul(optarg, NULL, 10); break;
+        case 'n': blocks = strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: spectrum_decode device\n"
+                "       spectrum_decode -t [-R raw] [-d dma] [-c corrupt one byte in n] [-n blocks]\n");
+            return 2;
+        }
+    }
+    if (test) return self_test(encoding, corrupt, blocks, dma);
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: spectrum_decode device\n");
+        return 2;
+    }
+    int fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return 1;
+    }
+    if (isatty(fd)) open_raw(fd);
+    FFTStreamDecoder dec;
+    uint8_t data[4096];
+    ssize_t len;
+    while ((len = read(fd, data, sizeof(data))) > 0) {
+        for (ssize_t pos = 0; ; ) {
+            pos += dec.feed(data + pos, len - pos);
+            if (!dec.available()) break;
+            print_frame(dec);
+        }
+    }
+    close(fd);
+    fprintf(stderr, "%u bad packets, %u deltas skipped, %u frames missing\n",
+        dec.errors(), dec.skipped(), dec.missing());
+    return 0;
+}
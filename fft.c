@@ -40,6 +40,7 @@
 // Teensy Audio Library adapted version. Colin Duffy
 
 #include "arm_math.h"
+#include <string.h>
 /**
  @ingroup groupTransforms
  */
@@ -71,8 +72,16 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 inline void arm_radix4_butterfly_q15_stage1(q15_t * pSrc16, uint32_t fftLen, q15_t * pCoef16, uint32_t twidCoefModifier) __attribute__((always_inline, unused));
 
+inline void arm_radix4_butterfly_q15_stage1_packed(q15_t * pSrc16, uint32_t fftLen, const q31_t * pTwid) __attribute__((always_inline, unused));
+
 inline void arm_radix4_butterfly_q15_stage2(q15_t * pSrc16, uint32_t fftLen, q15_t * pCoef16, uint32_t twidCoefModifier) __attribute__((always_inline, unused));
 
+inline void arm_radix4_butterfly_q15_middle(q15_t * pSrc16, uint32_t fftLen, uint32_t n1, q15_t * pCoef16, uint32_t twidCoefModifier) __attribute__((always_inline, unused));
+
+inline void arm_radix4_butterfly_q15_middle_packed(q15_t * pSrc16, uint32_t fftLen, uint32_t n1, const q31_t * pTwid) __attribute__((always_inline, unused));
+
+inline void arm_radix8_butterfly_q15_middle(q15_t * pSrc16, uint32_t fftLen, uint32_t n1, const q31_t * pTwid) __attribute__((always_inline, unused));
+
 inline void arm_radix4_butterfly_q15_stage3(q15_t * pSrc16, uint32_t fftLen, q15_t * pCoef16, uint32_t twidCoefModifier) __attribute__((always_inline, unused));
 
 // ifft
@@ -128,6 +137,332 @@ void arm_cfft_radix4_q15_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t *
         arm_bitreversal_q15(pSrc, S->fftLen, S->bitRevFactor, S->pBitRevTable);
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+/*
+ 1024 point forward fft stages. With fftLen a constant every loop bound and
+ index step of the always_inline butterflies folds at compile time, and the
+ middle stage is unrolled into its three radix-4 passes.
+ 
+ The twiddles are read from a packed table instead of striding through the
+ 4096 point instance table. Each butterfly group's (C1, C2, C3) are stored
+ together in the order the passes visit them: 256 groups for stage 1, then
+ 64, 16 and 4 for the middle passes. The last stage has unit twiddles. The
+ table is const, so it stays in flash and costs no RAM. Its values are the
+ instance table's, round(x * 2^15) saturated, picked in that order.
+ arm_cfft_q15_1024_twiddle_ram() copies it into a caller's buffer for
+ reads from RAM instead.
+ */
+#define TWIDDLE_1024_GROUPS (256u + 64u + 16u + 4u)
+
+static const q15_t twiddle1024_flash[TWIDDLE_1024_GROUPS * 6u] __attribute__ ((aligned (4))) = {
+    32767, 0, 32767, 0, 32767, 0, 32767, 201, 32766, 402, 32762, 603,
+    32766, 402, 32758, 804, 32746, 1206, 32762, 603, 32746, 1206, 32718, 1809,
+    32758, 804, 32729, 1608, 32679, 2411, 32753, 1005, 32706, 2009, 32629, 3012,
+    32746, 1206, 32679, 2411, 32568, 3612, 32738, 1407, 32647, 2811, 32496, 4211,
+    32729, 1608, 32610, 3212, 32413, 4808, 32718, 1809, 32568, 3612, 32319, 5404,
+    32706, 2009, 32522, 4011, 32214, 5998, 32693, 2210, 32470, 4410, 32099, 6590,
+    32679, 2411, 32413, 4808, 31972, 7180, 32664, 2611, 32352, 5205, 31834, 7767,
+    32647, 2811, 32286, 5602, 31686, 8351, 32629, 3012, 32214, 5998, 31527, 8933,
+    32610, 3212, 32138, 6393, 31357, 9512, 32590, 3412, 32058, 6787, 31177, 10088,
+    32568, 3612, 31972, 7180, 30986, 10660, 32546, 3812, 31881, 7571, 30784, 11228,
+    32522, 4011, 31786, 7962, 30572, 11793, 32496, 4211, 31686, 8351, 30350, 12354,
+    32470, 4410, 31581, 8740, 30118, 12910, 32442, 4609, 31471, 9127, 29875, 13463,
+    32413, 4808, 31357, 9512, 29622, 14010, 32383, 5007, 31238, 9896, 29359, 14553,
+    32352, 5205, 31114, 10279, 29086, 15091, 32319, 5404, 30986, 10660, 28803, 15624,
+    32286, 5602, 30853, 11039, 28511, 16151, 32251, 5800, 30715, 11417, 28209, 16673,
+    32214, 5998, 30572, 11793, 27897, 17190, 32177, 6195, 30425, 12167, 27576, 17700,
+    32138, 6393, 30274, 12540, 27246, 18205, 32099, 6590, 30118, 12910, 26906, 18703,
+    32058, 6787, 29957, 13279, 26557, 19195, 32015, 6983, 29792, 13646, 26199, 19681,
+    31972, 7180, 29622, 14010, 25833, 20160, 31927, 7376, 29448, 14373, 25457, 20632,
+    31881, 7571, 29269, 14733, 25073, 21097, 31834, 7767, 29086, 15091, 24680, 21555,
+    31786, 7962, 28899, 15447, 24279, 22006, 31737, 8157, 28707, 15800, 23870, 22449,
+    31686, 8351, 28511, 16151, 23453, 22884, 31634, 8546, 28311, 16500, 23028, 23312,
+    31581, 8740, 28106, 16846, 22595, 23732, 31527, 8933, 27897, 17190, 22154, 24144,
+    31471, 9127, 27684, 17531, 21706, 24548, 31415, 9319, 27467, 17869, 21251, 24943,
+    31357, 9512, 27246, 18205, 20788, 25330, 31298, 9704, 27020, 18538, 20318, 25708,
+    31238, 9896, 26791, 18868, 19841, 26078, 31177, 10088, 26557, 19195, 19358, 26439,
+    31114, 10279, 26320, 19520, 18868, 26791, 31050, 10469, 26078, 19841, 18372, 27133,
+    30986, 10660, 25833, 20160, 17869, 27467, 30920, 10850, 25583, 20475, 17361, 27791,
+    30853, 11039, 25330, 20788, 16846, 28106, 30784, 11228, 25073, 21097, 16326, 28411,
+    30715, 11417, 24812, 21403, 15800, 28707, 30644, 11605, 24548, 21706, 15269, 28993,
+    30572, 11793, 24279, 22006, 14733, 29269, 30499, 11980, 24008, 22302, 14192, 29535,
+    30425, 12167, 23732, 22595, 13646, 29792, 30350, 12354, 23453, 22884, 13095, 30038,
+    30274, 12540, 23170, 23170, 12540, 30274, 30196, 12725, 22884, 23453, 11980, 30499,
+    30118, 12910, 22595, 23732, 11417, 30715, 30038, 13095, 22302, 24008, 10850, 30920,
+    29957, 13279, 22006, 24279, 10279, 31114, 29875, 13463, 21706, 24548, 9704, 31298,
+    29792, 13646, 21403, 24812, 9127, 31471, 29707, 13828, 21097, 25073, 8546, 31634,
+    29622, 14010, 20788, 25330, 7962, 31786, 29535, 14192, 20475, 25583, 7376, 31927,
+    29448, 14373, 20160, 25833, 6787, 32058, 29359, 14553, 19841, 26078, 6195, 32177,
+    29269, 14733, 19520, 26320, 5602, 32286, 29178, 14912, 19195, 26557, 5007, 32383,
+    29086, 15091, 18868, 26791, 4410, 32470, 28993, 15269, 18538, 27020, 3812, 32546,
+    28899, 15447, 18205, 27246, 3212, 32610, 28803, 15624, 17869, 27467, 2611, 32664,
+    28707, 15800, 17531, 27684, 2009, 32706, 28610, 15976, 17190, 27897, 1407, 32738,
+    28511, 16151, 16846, 28106, 804, 32758, 28411, 16326, 16500, 28311, 201, 32767,
+    28311, 16500, 16151, 28511, -402, 32766, 28209, 16673, 15800, 28707, -1005, 32753,
+    28106, 16846, 15447, 28899, -1608, 32729, 28002, 17018, 15091, 29086, -2210, 32693,
+    27897, 17190, 14733, 29269, -2811, 32647, 27791, 17361, 14373, 29448, -3412, 32590,
+    27684, 17531, 14010, 29622, -4011, 32522, 27576, 17700, 13646, 29792, -4609, 32442,
+    27467, 17869, 13279, 29957, -5205, 32352, 27357, 18037, 12910, 30118, -5800, 32251,
+    27246, 18205, 12540, 30274, -6393, 32138, 27133, 18372, 12167, 30425, -6983, 32015,
+    27020, 18538, 11793, 30572, -7571, 31881, 26906, 18703, 11417, 30715, -8157, 31737,
+    26791, 18868, 11039, 30853, -8740, 31581, 26674, 19032, 10660, 30986, -9319, 31415,
+    26557, 19195, 10279, 31114, -9896, 31238, 26439, 19358, 9896, 31238, -10469, 31050,
+    26320, 19520, 9512, 31357, -11039, 30853, 26199, 19681, 9127, 31471, -11605, 30644,
+    26078, 19841, 8740, 31581, -12167, 30425, 25956, 20001, 8351, 31686, -12725, 30196,
+    25833, 20160, 7962, 31786, -13279, 29957, 25708, 20318, 7571, 31881, -13828, 29707,
+    25583, 20475, 7180, 31972, -14373, 29448, 25457, 20632, 6787, 32058, -14912, 29178,
+    25330, 20788, 6393, 32138, -15447, 28899, 25202, 20943, 5998, 32214, -15976, 28610,
+    25073, 21097, 5602, 32286, -16500, 28311, 24943, 21251, 5205, 32352, -17018, 28002,
+    24812, 21403, 4808, 32413, -17531, 27684, 24680, 21555, 4410, 32470, -18037, 27357,
+    24548, 21706, 4011, 32522, -18538, 27020, 24414, 21856, 3612, 32568, -19032, 26674,
+    24279, 22006, 3212, 32610, -19520, 26320, 24144, 22154, 2811, 32647, -20001, 25956,
+    24008, 22302, 2411, 32679, -20475, 25583, 23870, 22449, 2009, 32706, -20943, 25202,
+    23732, 22595, 1608, 32729, -21403, 24812, 23593, 22740, 1206, 32746, -21856, 24414,
+    23453, 22884, 804, 32758, -22302, 24008, 23312, 23028, 402, 32766, -22740, 23593,
+    23170, 23170, 0, 32767, -23170, 23170, 23028, 23312, -402, 32766, -23593, 22740,
+    22884, 23453, -804, 32758, -24008, 22302, 22740, 23593, -1206, 32746, -24414, 21856,
+    22595, 23732, -1608, 32729, -24812, 21403, 22449, 23870, -2009, 32706, -25202, 20943,
+    22302, 24008, -2411, 32679, -25583, 20475, 22154, 24144, -2811, 32647, -25956, 20001,
+    22006, 24279, -3212, 32610, -26320, 19520, 21856, 24414, -3612, 32568, -26674, 19032,
+    21706, 24548, -4011, 32522, -27020, 18538, 21555, 24680, -4410, 32470, -27357, 18037,
+    21403, 24812, -4808, 32413, -27684, 17531, 21251, 24943, -5205, 32352, -28002, 17018,
+    21097, 25073, -5602, 32286, -28311, 16500, 20943, 25202, -5998, 32214, -28610, 15976,
+    20788, 25330, -6393, 32138, -28899, 15447, 20632, 25457, -6787, 32058, -29178, 14912,
+    20475, 25583, -7180, 31972, -29448, 14373, 20318, 25708, -7571, 31881, -29707, 13828,
+    20160, 25833, -7962, 31786, -29957, 13279, 20001, 25956, -8351, 31686, -30196, 12725,
+    19841, 26078, -8740, 31581, -30425, 12167, 19681, 26199, -9127, 31471, -30644, 11605,
+    19520, 26320, -9512, 31357, -30853, 11039, 19358, 26439, -9896, 31238, -31050, 10469,
+    19195, 26557, -10279, 31114, -31238, 9896, 19032, 26674, -10660, 30986, -31415, 9319,
+    18868, 26791, -11039, 30853, -31581, 8740, 18703, 26906, -11417, 30715, -31737, 8157,
+    18538, 27020, -11793, 30572, -31881, 7571, 18372, 27133, -12167, 30425, -32015, 6983,
+    18205, 27246, -12540, 30274, -32138, 6393, 18037, 27357, -12910, 30118, -32251, 5800,
+    17869, 27467, -13279, 29957, -32352, 5205, 17700, 27576, -13646, 29792, -32442, 4609,
+    17531, 27684, -14010, 29622, -32522, 4011, 17361, 27791, -14373, 29448, -32590, 3412,
+    17190, 27897, -14733, 29269, -32647, 2811, 17018, 28002, -15091, 29086, -32693, 2210,
+    16846, 28106, -15447, 28899, -32729, 1608, 16673, 28209, -15800, 28707, -32753, 1005,
+    16500, 28311, -16151, 28511, -32766, 402, 16326, 28411, -16500, 28311, -32767, -201,
+    16151, 28511, -16846, 28106, -32758, -804, 15976, 28610, -17190, 27897, -32738, -1407,
+    15800, 28707, -17531, 27684, -32706, -2009, 15624, 28803, -17869, 27467, -32664, -2611,
+    15447, 28899, -18205, 27246, -32610, -3212, 15269, 28993, -18538, 27020, -32546, -3812,
+    15091, 29086, -18868, 26791, -32470, -4410, 14912, 29178, -19195, 26557, -32383, -5007,
+    14733, 29269, -19520, 26320, -32286, -5602, 14553, 29359, -19841, 26078, -32177, -6195,
+    14373, 29448, -20160, 25833, -32058, -6787, 14192, 29535, -20475, 25583, -31927, -7376,
+    14010, 29622, -20788, 25330, -31786, -7962, 13828, 29707, -21097, 25073, -31634, -8546,
+    13646, 29792, -21403, 24812, -31471, -9127, 13463, 29875, -21706, 24548, -31298, -9704,
+    13279, 29957, -22006, 24279, -31114, -10279, 13095, 30038, -22302, 24008, -30920, -10850,
+    12910, 30118, -22595, 23732, -30715, -11417, 12725, 30196, -22884, 23453, -30499, -11980,
+    12540, 30274, -23170, 23170, -30274, -12540, 12354, 30350, -23453, 22884, -30038, -13095,
+    12167, 30425, -23732, 22595, -29792, -13646, 11980, 30499, -24008, 22302, -29535, -14192,
+    11793, 30572, -24279, 22006, -29269, -14733, 11605, 30644, -24548, 21706, -28993, -15269,
+    11417, 30715, -24812, 21403, -28707, -15800, 11228, 30784, -25073, 21097, -28411, -16326,
+    11039, 30853, -25330, 20788, -28106, -16846, 10850, 30920, -25583, 20475, -27791, -17361,
+    10660, 30986, -25833, 20160, -27467, -17869, 10469, 31050, -26078, 19841, -27133, -18372,
+    10279, 31114, -26320, 19520, -26791, -18868, 10088, 31177, -26557, 19195, -26439, -19358,
+    9896, 31238, -26791, 18868, -26078, -19841, 9704, 31298, -27020, 18538, -25708, -20318,
+    9512, 31357, -27246, 18205, -25330, -20788, 9319, 31415, -27467, 17869, -24943, -21251,
+    9127, 31471, -27684, 17531, -24548, -21706, 8933, 31527, -27897, 17190, -24144, -22154,
+    8740, 31581, -28106, 16846, -23732, -22595, 8546, 31634, -28311, 16500, -23312, -23028,
+    8351, 31686, -28511, 16151, -22884, -23453, 8157, 31737, -28707, 15800, -22449, -23870,
+    7962, 31786, -28899, 15447, -22006, -24279, 7767, 31834, -29086, 15091, -21555, -24680,
+    7571, 31881, -29269, 14733, -21097, -25073, 7376, 31927, -29448, 14373, -20632, -25457,
+    7180, 31972, -29622, 14010, -20160, -25833, 6983, 32015, -29792, 13646, -19681, -26199,
+    6787, 32058, -29957, 13279, -19195, -26557, 6590, 32099, -30118, 12910, -18703, -26906,
+    6393, 32138, -30274, 12540, -18205, -27246, 6195, 32177, -30425, 12167, -17700, -27576,
+    5998, 32214, -30572, 11793, -17190, -27897, 5800, 32251, -30715, 11417, -16673, -28209,
+    5602, 32286, -30853, 11039, -16151, -28511, 5404, 32319, -30986, 10660, -15624, -28803,
+    5205, 32352, -31114, 10279, -15091, -29086, 5007, 32383, -31238, 9896, -14553, -29359,
+    4808, 32413, -31357, 9512, -14010, -29622, 4609, 32442, -31471, 9127, -13463, -29875,
+    4410, 32470, -31581, 8740, -12910, -30118, 4211, 32496, -31686, 8351, -12354, -30350,
+    4011, 32522, -31786, 7962, -11793, -30572, 3812, 32546, -31881, 7571, -11228, -30784,
+    3612, 32568, -31972, 7180, -10660, -30986, 3412, 32590, -32058, 6787, -10088, -31177,
+    3212, 32610, -32138, 6393, -9512, -31357, 3012, 32629, -32214, 5998, -8933, -31527,
+    2811, 32647, -32286, 5602, -8351, -31686, 2611, 32664, -32352, 5205, -7767, -31834,
+    2411, 32679, -32413, 4808, -7180, -31972, 2210, 32693, -32470, 4410, -6590, -32099,
+    2009, 32706, -32522, 4011, -5998, -32214, 1809, 32718, -32568, 3612, -5404, -32319,
+    1608, 32729, -32610, 3212, -4808, -32413, 1407, 32738, -32647, 2811, -4211, -32496,
+    1206, 32746, -32679, 2411, -3612, -32568, 1005, 32753, -32706, 2009, -3012, -32629,
+    804, 32758, -32729, 1608, -2411, -32679, 603, 32762, -32746, 1206, -1809, -32718,
+    402, 32766, -32758, 804, -1206, -32746, 201, 32767, -32766, 402, -603, -32762,
+    32767, 0, 32767, 0, 32767, 0, 32758, 804, 32729, 1608, 32679, 2411,
+    32729, 1608, 32610, 3212, 32413, 4808, 32679, 2411, 32413, 4808, 31972, 7180,
+    32610, 3212, 32138, 6393, 31357, 9512, 32522, 4011, 31786, 7962, 30572, 11793,
+    32413, 4808, 31357, 9512, 29622, 14010, 32286, 5602, 30853, 11039, 28511, 16151,
+    32138, 6393, 30274, 12540, 27246, 18205, 31972, 7180, 29622, 14010, 25833, 20160,
+    31786, 7962, 28899, 15447, 24279, 22006, 31581, 8740, 28106, 16846, 22595, 23732,
+    31357, 9512, 27246, 18205, 20788, 25330, 31114, 10279, 26320, 19520, 18868, 26791,
+    30853, 11039, 25330, 20788, 16846, 28106, 30572, 11793, 24279, 22006, 14733, 29269,
+    30274, 12540, 23170, 23170, 12540, 30274, 29957, 13279, 22006, 24279, 10279, 31114,
+    29622, 14010, 20788, 25330, 7962, 31786, 29269, 14733, 19520, 26320, 5602, 32286,
+    28899, 15447, 18205, 27246, 3212, 32610, 28511, 16151, 16846, 28106, 804, 32758,
+    28106, 16846, 15447, 28899, -1608, 32729, 27684, 17531, 14010, 29622, -4011, 32522,
+    27246, 18205, 12540, 30274, -6393, 32138, 26791, 18868, 11039, 30853, -8740, 31581,
+    26320, 19520, 9512, 31357, -11039, 30853, 25833, 20160, 7962, 31786, -13279, 29957,
+    25330, 20788, 6393, 32138, -15447, 28899, 24812, 21403, 4808, 32413, -17531, 27684,
+    24279, 22006, 3212, 32610, -19520, 26320, 23732, 22595, 1608, 32729, -21403, 24812,
+    23170, 23170, 0, 32767, -23170, 23170, 22595, 23732, -1608, 32729, -24812, 21403,
+    22006, 24279, -3212, 32610, -26320, 19520, 21403, 24812, -4808, 32413, -27684, 17531,
+    20788, 25330, -6393, 32138, -28899, 15447, 20160, 25833, -7962, 31786, -29957, 13279,
+    19520, 26320, -9512, 31357, -30853, 11039, 18868, 26791, -11039, 30853, -31581, 8740,
+    18205, 27246, -12540, 30274, -32138, 6393, 17531, 27684, -14010, 29622, -32522, 4011,
+    16846, 28106, -15447, 28899, -32729, 1608, 16151, 28511, -16846, 28106, -32758, -804,
+    15447, 28899, -18205, 27246, -32610, -3212, 14733, 29269, -19520, 26320, -32286, -5602,
+    14010, 29622, -20788, 25330, -31786, -7962, 13279, 29957, -22006, 24279, -31114, -10279,
+    12540, 30274, -23170, 23170, -30274, -12540, 11793, 30572, -24279, 22006, -29269, -14733,
+    11039, 30853, -25330, 20788, -28106, -16846, 10279, 31114, -26320, 19520, -26791, -18868,
+    9512, 31357, -27246, 18205, -25330, -20788, 8740, 31581, -28106, 16846, -23732, -22595,
+    7962, 31786, -28899, 15447, -22006, -24279, 7180, 31972, -29622, 14010, -20160, -25833,
+    6393, 32138, -30274, 12540, -18205, -27246, 5602, 32286, -30853, 11039, -16151, -28511,
+    4808, 32413, -31357, 9512, -14010, -29622, 4011, 32522, -31786, 7962, -11793, -30572,
+    3212, 32610, -32138, 6393, -9512, -31357, 2411, 32679, -32413, 4808, -7180, -31972,
+    1608, 32729, -32610, 3212, -4808, -32413, 804, 32758, -32729, 1608, -2411, -32679,
+    32767, 0, 32767, 0, 32767, 0, 32610, 3212, 32138, 6393, 31357, 9512,
+    32138, 6393, 30274, 12540, 27246, 18205, 31357, 9512, 27246, 18205, 20788, 25330,
+    30274, 12540, 23170, 23170, 12540, 30274, 28899, 15447, 18205, 27246, 3212, 32610,
+    27246, 18205, 12540, 30274, -6393, 32138, 25330, 20788, 6393, 32138, -15447, 28899,
+    23170, 23170, 0, 32767, -23170, 23170, 20788, 25330, -6393, 32138, -28899, 15447,
+    18205, 27246, -12540, 30274, -32138, 6393, 15447, 28899, -18205, 27246, -32610, -3212,
+    12540, 30274, -23170, 23170, -30274, -12540, 9512, 31357, -27246, 18205, -25330, -20788,
+    6393, 32138, -30274, 12540, -18205, -27246, 3212, 32610, -32138, 6393, -9512, -31357,
+    32767, 0, 32767, 0, 32767, 0, 30274, 12540, 23170, 23170, 12540, 30274,
+    23170, 23170, 0, 32767, -23170, 23170, 12540, 30274, -23170, 23170, -30274, -12540
+};
+
+static const q31_t *twiddle1024 = (const q31_t *)twiddle1024_flash;
+
+void arm_cfft_radix4_q15_1024_stage1(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc) {
+    arm_radix4_butterfly_q15_stage1_packed(pSrc, 1024u, twiddle1024);
+}
+
+void arm_cfft_radix4_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc) {
+    const q31_t *pTwid = twiddle1024;
+    arm_radix4_butterfly_q15_middle_packed(pSrc, 1024u, 256u, pTwid + 3u * 256u);
+    arm_radix4_butterfly_q15_middle_packed(pSrc, 1024u, 64u, pTwid + 3u * (256u + 64u));
+    arm_radix4_butterfly_q15_middle_packed(pSrc, 1024u, 16u, pTwid + 3u * (256u + 64u + 16u));
+}
+
+void arm_cfft_radix4_q15_1024_stage3(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc) {
+    arm_radix4_butterfly_q15_stage3(pSrc, 1024u, S->pTwiddle, S->twidCoefModifier);
+    
+    if (S->bitReverseFlag == 1u) {
+        /*  Bit Reversal */
+        arm_bitreversal_q15(pSrc, 1024u, S->bitRevFactor, S->pBitRevTable);
+    }
+}
+/*
+ Radix-8 alternative for the 1024 point middle stage: two radix-8 passes
+ with spans 256 and 32 replace the three radix-4 passes, saving one pass of
+ loads and stores over the buffer. Stage 1 and stage 3 are shared with the
+ radix-4 kernel and the output is the same bit reversed format. Its
+ twiddles, W^j .. W^7j per group, run past the three quarter circle the
+ instance table covers, so the packed table holds them folded back,
+ (cos(2pi - a), -sin(2pi - a)). It is const in flash like the radix-4 one.
+ */
+#define TWIDDLE_1024_RADIX8_GROUPS (32u + 4u)
+
+static const q15_t twiddle1024_radix8_flash[TWIDDLE_1024_RADIX8_GROUPS * 14u] __attribute__ ((aligned (4))) = {
+    32767, 0, 32767, 0, 32767, 0, 32767, 0, 32767, 0, 32767, 0,
+    32767, 0, 32758, 804, 32729, 1608, 32679, 2411, 32610, 3212, 32522, 4011,
+    32413, 4808, 32286, 5602, 32729, 1608, 32610, 3212, 32413, 4808, 32138, 6393,
+    31786, 7962, 31357, 9512, 30853, 11039, 32679, 2411, 32413, 4808, 31972, 7180,
+    31357, 9512, 30572, 11793, 29622, 14010, 28511, 16151, 32610, 3212, 32138, 6393,
+    31357, 9512, 30274, 12540, 28899, 15447, 27246, 18205, 25330, 20788, 32522, 4011,
+    31786, 7962, 30572, 11793, 28899, 15447, 26791, 18868, 24279, 22006, 21403, 24812,
+    32413, 4808, 31357, 9512, 29622, 14010, 27246, 18205, 24279, 22006, 20788, 25330,
+    16846, 28106, 32286, 5602, 30853, 11039, 28511, 16151, 25330, 20788, 21403, 24812,
+    16846, 28106, 11793, 30572, 32138, 6393, 30274, 12540, 27246, 18205, 23170, 23170,
+    18205, 27246, 12540, 30274, 6393, 32138, 31972, 7180, 29622, 14010, 25833, 20160,
+    20788, 25330, 14733, 29269, 7962, 31786, 804, 32758, 31786, 7962, 28899, 15447,
+    24279, 22006, 18205, 27246, 11039, 30853, 3212, 32610, -4808, 32413, 31581, 8740,
+    28106, 16846, 22595, 23732, 15447, 28899, 7180, 31972, -1608, 32729, -10279, 31114,
+    31357, 9512, 27246, 18205, 20788, 25330, 12540, 30274, 3212, 32610, -6393, 32138,
+    -15447, 28899, 31114, 10279, 26320, 19520, 18868, 26791, 9512, 31357, -804, 32758,
+    -11039, 30853, -20160, 25833, 30853, 11039, 25330, 20788, 16846, 28106, 6393, 32138,
+    -4808, 32413, -15447, 28899, -24279, 22006, 30572, 11793, 24279, 22006, 14733, 29269,
+    3212, 32610, -8740, 31581, -19520, 26320, -27684, 17531, 30274, 12540, 23170, 23170,
+    12540, 30274, 0, 32767, -12540, 30274, -23170, 23170, -30274, 12540, 29957, 13279,
+    22006, 24279, 10279, 31114, -3212, 32610, -16151, 28511, -26320, 19520, -31972, 7180,
+    29622, 14010, 20788, 25330, 7962, 31786, -6393, 32138, -19520, 26320, -28899, 15447,
+    -32729, 1608, 29269, 14733, 19520, 26320, 5602, 32286, -9512, 31357, -22595, 23732,
+    -30853, 11039, -32522, -4011, 28899, 15447, 18205, 27246, 3212, 32610, -12540, 30274,
+    -25330, 20788, -32138, 6393, -31357, -9512, 28511, 16151, 16846, 28106, 804, 32758,
+    -15447, 28899, -27684, 17531, -32729, 1608, -29269, -14733, 28106, 16846, 15447, 28899,
+    -1608, 32729, -18205, 27246, -29622, 14010, -32610, -3212, -26320, -19520, 27684, 17531,
+    14010, 29622, -4011, 32522, -20788, 25330, -31114, 10279, -31786, -7962, -22595, -23732,
+    27246, 18205, 12540, 30274, -6393, 32138, -23170, 23170, -32138, 6393, -30274, -12540,
+    -18205, -27246, 26791, 18868, 11039, 30853, -8740, 31581, -25330, 20788, -32679, 2411,
+    -28106, -16846, -13279, -29957, 26320, 19520, 9512, 31357, -11039, 30853, -27246, 18205,
+    -32729, -1608, -25330, -20788, -7962, -31786, 25833, 20160, 7962, 31786, -13279, 29957,
+    -28899, 15447, -32286, -5602, -22006, -24279, -2411, -32679, 25330, 20788, 6393, 32138,
+    -15447, 28899, -30274, 12540, -31357, -9512, -18205, -27246, 3212, -32610, 24812, 21403,
+    4808, 32413, -17531, 27684, -31357, 9512, -29957, -13279, -14010, -29622, 8740, -31581,
+    24279, 22006, 3212, 32610, -19520, 26320, -32138, 6393, -28106, -16846, -9512, -31357,
+    14010, -29622, 23732, 22595, 1608, 32729, -21403, 24812, -32610, 3212, -25833, -20160,
+    -4808, -32413, 18868, -26791, 32767, 0, 32767, 0, 32767, 0, 32767, 0,
+    32767, 0, 32767, 0, 32767, 0, 32138, 6393, 30274, 12540, 27246, 18205,
+    23170, 23170, 18205, 27246, 12540, 30274, 6393, 32138, 30274, 12540, 23170, 23170,
+    12540, 30274, 0, 32767, -12540, 30274, -23170, 23170, -30274, 12540, 27246, 18205,
+    12540, 30274, -6393, 32138, -23170, 23170, -32138, 6393, -30274, -12540, -18205, -27246
+};
+
+static const q31_t *twiddle1024_radix8 = (const q31_t *)twiddle1024_radix8_flash;
+
+void arm_cfft_radix8_q15_1024_stage2(const arm_cfft_radix4_instance_q15 * S, q15_t * pSrc) {
+    const q31_t *pTwid = twiddle1024_radix8;
+    (void) S;
+    arm_radix8_butterfly_q15_middle(pSrc, 1024u, 256u, pTwid);
+    arm_radix8_butterfly_q15_middle(pSrc, 1024u, 32u, pTwid + 7u * 32u);
+}
+
+/*
+ Copies both packed tables into buffer, TWIDDLE_1024_GROUPS * 3 words for
+ radix-4 followed by TWIDDLE_1024_RADIX8_GROUPS * 7 for radix-8, and has
+ the stages read them from there. NULL goes back to the flash tables. The
+ copy is made before the stages are pointed at it, and both hold the same
+ values, so a stage running meanwhile reads either one.
+ */
+void arm_cfft_q15_1024_twiddle_ram(q31_t * buffer) {
+    if (buffer == NULL) {
+        twiddle1024 = (const q31_t *)twiddle1024_flash;
+        twiddle1024_radix8 = (const q31_t *)twiddle1024_radix8_flash;
+        return;
+    }
+    memcpy(buffer, twiddle1024_flash, sizeof(twiddle1024_flash));
+    memcpy(buffer + TWIDDLE_1024_GROUPS * 3u, twiddle1024_radix8_flash, sizeof(twiddle1024_radix8_flash));
+    twiddle1024 = buffer;
+    twiddle1024_radix8 = buffer + TWIDDLE_1024_GROUPS * 3u;
+}
+
+/*
+ Instance init for the 1024 point stages above. The instance is a const
+ made of the values the CMSIS init sets for 1024 points, the 4096 point
+ tables and their step 4, so init is a copy with no runtime work and no
+ lazy state. That makes it safe from a static object's constructor and
+ from any number of threads at once. The stages need no bit reversal
+ table, the magnitude loop reads bin i at __RBIT(i) >> 22, a single cycle
+ instruction that beats a table load. Other sizes and the inverse
+ transform fall through to the CMSIS init.
+ */
+static const arm_cfft_radix4_instance_q15 fft1024_instance = {
+    .fftLen = 1024u,
+    .ifftFlag = 0u,
+    .bitReverseFlag = 0u,
+    .pTwiddle = (q15_t *) twiddleCoef_4096_q15,
+    .pBitRevTable = (uint16_t *) & armBitRevTable[3],
+    .twidCoefModifier = 4u,
+    .bitRevFactor = 4u
+};
+
+arm_status arm_cfft_radix4_init_fast_q15(arm_cfft_radix4_instance_q15 * S, uint16_t fftLen, uint8_t ifftFlag, uint8_t bitReverseFlag) {
+    if (fftLen != 1024u || ifftFlag != 0u) {
+        return arm_cfft_radix4_init_q15(S, fftLen, ifftFlag, bitReverseFlag);
+    }
+    *S = fft1024_instance;
+    S->bitReverseFlag = bitReverseFlag;
+    return ARM_MATH_SUCCESS;
+}
 /**
  @} end of Radix4_CFFT_CIFFT group
  */
@@ -401,171 +736,527 @@ inline void arm_radix4_butterfly_q15_stage1(q15_t * pSrc16, uint32_t fftLen, q15
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
-inline void arm_radix4_butterfly_q15_stage2(q15_t * pSrc16, uint32_t fftLen, q15_t * pCoef16, uint32_t twidCoefModifier) {
+inline void arm_radix4_butterfly_q15_stage1_packed(q15_t * pSrc16, uint32_t fftLen, const q31_t * pTwid) {
+    /*  start of first stage process */
 #ifndef ARM_MATH_CM0
-    /*  Initializations for the middle stage */
+    /*  Initializations for the first stage */
     q31_t R, S, T, U;
     q31_t C1, C2, C3, out1, out2;
     q15_t in;
-    uint32_t i3, i2, i1, i0, ic, n2, n1, k, j;
+    
+    uint32_t i3, i2, i1, i0, n2, n1, j;
     
     n2 = fftLen;
+    n1 = n2;
+    
     /* n2 = fftLen/4 */
     n2 >>= 2u;
     
-    /*  Twiddle coefficients index modifier */
-    twidCoefModifier <<= 2u;
-    /*  Calculation of Middle stage */
-    for (k = fftLen / 4u; k > 4u; k >>= 2u)
+    /* Index for twiddle coefficient */
+    
+    /* Index for input read and output write */
+    i0 = 0u;
+    j = n2;
+    
+    do
     {
-        /*  Initializations for the middle stage */
-        n1 = n2;
-        n2 >>= 2u;
-        ic = 0u;
+        /*  Butterfly implementation */
+        
+        /*  index calculation for the input as, */
+        /*  pSrc16[i0 + 0], pSrc16[i0 + fftLen/4], pSrc16[i0 + fftLen/2], pSrc16[i0 + 3fftLen/4] */
+        i1 = i0 + n2;
+        i2 = i1 + n2;
+        i3 = i2 + n2;
+        
+        /*  Reading i0, i0+fftLen/2 inputs */
+        /* Read ya (real), xa(imag) input */
+        T = _SIMD32_OFFSET(pSrc16 + (2u * i0));
+        in = ((int16_t) (T & 0xFFFF)) >> 2;
+        T = ((T >> 2) & 0xFFFF0000) | (in & 0xFFFF);
+        
+        /* Read yc (real), xc(imag) input */
+        S = _SIMD32_OFFSET(pSrc16 + (2u * i2));
+        in = ((int16_t) (S & 0xFFFF)) >> 2;
+        S = ((S >> 2) & 0xFFFF0000) | (in & 0xFFFF);
+        
+        /* R = packed((ya + yc), (xa + xc) ) */
+        R = __QADD16(T, S);
+        
+        /* S = packed((ya - yc), (xa - xc) ) */
+        S = __QSUB16(T, S);
+        
+        /*  Reading i0+fftLen/4 , i0+3fftLen/4 inputs */
+        /* Read yb (real), xb(imag) input */
+        T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
+        in = ((int16_t) (T & 0xFFFF)) >> 2;
+        T = ((T >> 2) & 0xFFFF0000) | (in & 0xFFFF);
+        
+        /* Read yd (real), xd(imag) input */
+        U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
+        in = ((int16_t) (U & 0xFFFF)) >> 2;
+        U = ((U >> 2) & 0xFFFF0000) | (in & 0xFFFF);
+        
+        /* T = packed((yb + yd), (xb + xd) ) */
+        T = __QADD16(T, U);
+        
+        /*  writing the butterfly processed i0 sample */
+        /* xa' = xa + xb + xc + xd */
+        /* ya' = ya + yb + yc + yd */
+        _SIMD32_OFFSET(pSrc16 + (2u * i0)) = __SHADD16(R, T);
+        
+        /* R = packed((ya + yc) - (yb + yd), (xa + xc)- (xb + xd)) */
+        R = __QSUB16(R, T);
+        
+        /* co2 & si2 are read from the packed table */
+        C2 = pTwid[1];
         
-        for (j = 0u; j <= (n2 - 1u); j++)
-        {
-            /*  index calculation for the coefficients */
-            C1 = _SIMD32_OFFSET(pCoef16 + (2u * ic));
-            C2 = _SIMD32_OFFSET(pCoef16 + (4u * ic));
-            C3 = _SIMD32_OFFSET(pCoef16 + (6u * ic));
-            
-            /*  Twiddle coefficients index modifier */
-            ic = ic + twidCoefModifier;
-            
-            /*  Butterfly implementation */
-            for (i0 = j; i0 < fftLen; i0 += n1)
-            {
-                /*  index calculation for the input as, */
-                /*  pSrc16[i0 + 0], pSrc16[i0 + fftLen/4], pSrc16[i0 + fftLen/2], pSrc16[i0 + 3fftLen/4] */
-                i1 = i0 + n2;
-                i2 = i1 + n2;
-                i3 = i2 + n2;
-                
-                /*  Reading i0, i0+fftLen/2 inputs */
-                /* Read ya (real), xa(imag) input */
-                T = _SIMD32_OFFSET(pSrc16 + (2u * i0));
-                
-                /* Read yc (real), xc(imag) input */
-                S = _SIMD32_OFFSET(pSrc16 + (2u * i2));
-                
-                /* R = packed( (ya + yc), (xa + xc)) */
-                R = __QADD16(T, S);
-                
-                /* S = packed((ya - yc), (xa - xc)) */
-                S = __QSUB16(T, S);
-                
-                /*  Reading i0+fftLen/4 , i0+3fftLen/4 inputs */
-                /* Read yb (real), xb(imag) input */
-                T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
-                
-                /* Read yd (real), xd(imag) input */
-                U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
-                
-                /* T = packed( (yb + yd), (xb + xd)) */
-                T = __QADD16(T, U);
-                
-                /*  writing the butterfly processed i0 sample */
-                
-                /* xa' = xa + xb + xc + xd */
-                /* ya' = ya + yb + yc + yd */
-                out1 = __SHADD16(R, T);
-                in = ((int16_t) (out1 & 0xFFFF)) >> 1;
-                out1 = ((out1 >> 1) & 0xFFFF0000) | (in & 0xFFFF);
-                _SIMD32_OFFSET(pSrc16 + (2u * i0)) = out1;
-                
-                /* R = packed( (ya + yc) - (yb + yd), (xa + xc) - (xb + xd)) */
-                R = __SHSUB16(R, T);
-                
 #ifndef ARM_MATH_BIG_ENDIAN
-                
-                /* (ya-yb+yc-yd)* (si2) + (xa-xb+xc-xd)* co2 */
-                out1 = __SMUAD(C2, R) >> 16u;
-                
-                /* (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
-                out2 = __SMUSDX(C2, R);
-                
+        
+        /* xc' = (xa-xb+xc-xd)* co2 + (ya-yb+yc-yd)* (si2) */
+        out1 = __SMUAD(C2, R) >> 16u;
+        /* yc' = (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+        out2 = __SMUSDX(C2, R);
+        
 #else
-                
-                /* (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
-                out1 = __SMUSDX(R, C2) >> 16u;
-                
-                /* (ya-yb+yc-yd)* (si2) + (xa-xb+xc-xd)* co2 */
-                out2 = __SMUAD(C2, R);
-                
+        
+        /* xc' = (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+        out1 = __SMUSDX(R, C2) >> 16u;
+        /* yc' = (xa-xb+xc-xd)* co2 + (ya-yb+yc-yd)* (si2) */
+        out2 = __SMUAD(C2, R);
+        
 #endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
-                
-                /*  Reading i0+3fftLen/4 */
-                /* Read yb (real), xb(imag) input */
-                T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
-                
-                /*  writing the butterfly processed i0 + fftLen/4 sample */
-                /* xc' = (xa-xb+xc-xd)* co2 + (ya-yb+yc-yd)* (si2) */
-                /* yc' = (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
-                _SIMD32_OFFSET(pSrc16 + (2u * i1)) =
-                ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
-                
-                /*  Butterfly calculations */
-                
-                /* Read yd (real), xd(imag) input */
-                U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
-                
-                /* T = packed(yb-yd, xb-xd) */
-                T = __QSUB16(T, U);
-                
+        
+        /*  Reading i0+fftLen/4 */
+        /* T = packed(yb, xb) */
+        T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
+        in = ((int16_t) (T & 0xFFFF)) >> 2;
+        T = ((T >> 2) & 0xFFFF0000) | (in & 0xFFFF);
+        
+        /* writing the butterfly processed i0 + fftLen/4 sample */
+        /* writing output(xc', yc') in little endian format */
+        _SIMD32_OFFSET(pSrc16 + (2u * i1)) =
+        (q31_t) ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+        
+        /*  Butterfly calculations */
+        /* U = packed(yd, xd) */
+        U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
+        in = ((int16_t) (U & 0xFFFF)) >> 2;
+        U = ((U >> 2) & 0xFFFF0000) | (in & 0xFFFF);
+        
+        /* T = packed(yb-yd, xb-xd) */
+        T = __QSUB16(T, U);
+        
 #ifndef ARM_MATH_BIG_ENDIAN
-                
-                /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
-                R = __SHASX(S, T);
-                
-                /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
-                S = __SHSAX(S, T);
-                
-                
-                /*  Butterfly process for the i0+fftLen/2 sample */
-                out1 = __SMUAD(C1, S) >> 16u;
-                out2 = __SMUSDX(C1, S);
-                
+        
+        /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
+        R = __QASX(S, T);
+        /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
+        S = __QSAX(S, T);
+        
 #else
-                
-                /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
-                R = __SHSAX(S, T);
-                
-                /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
-                S = __SHASX(S, T);
-                
-                
-                /*  Butterfly process for the i0+fftLen/2 sample */
-                out1 = __SMUSDX(S, C1) >> 16u;
-                out2 = __SMUAD(C1, S);
-                
+        
+        /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
+        R = __QSAX(S, T);
+        /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
+        S = __QASX(S, T);
+        
 #endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
-                
-                /* xb' = (xa+yb-xc-yd)* co1 + (ya-xb-yc+xd)* (si1) */
-                /* yb' = (ya-xb-yc+xd)* co1 - (xa+yb-xc-yd)* (si1) */
-                _SIMD32_OFFSET(pSrc16 + (2u * i2)) =
-                ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
-                
-                /*  Butterfly process for the i0+3fftLen/4 sample */
-                
+        
+        /* co1 & si1 are read from SIMD Coefficient pointer */
+        C1 = pTwid[0];
+        /*  Butterfly process for the i0+fftLen/2 sample */
+        
 #ifndef ARM_MATH_BIG_ENDIAN
-                
-                out1 = __SMUAD(C3, R) >> 16u;
-                out2 = __SMUSDX(C3, R);
-                
+        
+        /* xb' = (xa+yb-xc-yd)* co1 + (ya-xb-yc+xd)* (si1) */
+        out1 = __SMUAD(C1, S) >> 16u;
+        /* yb' = (ya-xb-yc+xd)* co1 - (xa+yb-xc-yd)* (si1) */
+        out2 = __SMUSDX(C1, S);
+        
 #else
-                
-                out1 = __SMUSDX(R, C3) >> 16u;
-                out2 = __SMUAD(C3, R);
-                
+        
+        /* xb' = (ya-xb-yc+xd)* co1 - (xa+yb-xc-yd)* (si1) */
+        out1 = __SMUSDX(S, C1) >> 16u;
+        /* yb' = (xa+yb-xc-yd)* co1 + (ya-xb-yc+xd)* (si1) */
+        out2 = __SMUAD(C1, S);
+        
 #endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
-                
-                /* xd' = (xa-yb-xc+yd)* co3 + (ya+xb-yc-xd)* (si3) */
-                /* yd' = (ya+xb-yc-xd)* co3 - (xa-yb-xc+yd)* (si3) */
-                _SIMD32_OFFSET(pSrc16 + (2u * i3)) =
-                ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
-            }
+        
+        /* writing output(xb', yb') in little endian format */
+        _SIMD32_OFFSET(pSrc16 + (2u * i2)) =
+        ((out2) & 0xFFFF0000) | ((out1) & 0x0000FFFF);
+        
+        
+        /* co3 & si3 are read from SIMD Coefficient pointer */
+        C3 = pTwid[2];
+        /*  Butterfly process for the i0+3fftLen/4 sample */
+        
+#ifndef ARM_MATH_BIG_ENDIAN
+        
+        /* xd' = (xa-yb-xc+yd)* co3 + (ya+xb-yc-xd)* (si3) */
+        out1 = __SMUAD(C3, R) >> 16u;
+        /* yd' = (ya+xb-yc-xd)* co3 - (xa-yb-xc+yd)* (si3) */
+        out2 = __SMUSDX(C3, R);
+        
+#else
+        
+        /* xd' = (ya+xb-yc-xd)* co3 - (xa-yb-xc+yd)* (si3) */
+        out1 = __SMUSDX(R, C3) >> 16u;
+        /* yd' = (xa-yb-xc+yd)* co3 + (ya+xb-yc-xd)* (si3) */
+        out2 = __SMUAD(C3, R);
+        
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+        
+        /* writing output(xd', yd') in little endian format */
+        _SIMD32_OFFSET(pSrc16 + (2u * i3)) =
+        ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+        
+        /*  next group of the packed table */
+        pTwid += 3;
+        
+        /*  Updating input index */
+        i0 = i0 + 1u;
+        
+    } while (--j);
+#else
+    
+#endif /* #ifndef ARM_MATH_CM0 */
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline void arm_radix4_butterfly_q15_middle(q15_t * pSrc16, uint32_t fftLen, uint32_t n1, q15_t * pCoef16, uint32_t twidCoefModifier) {
+#ifndef ARM_MATH_CM0
+    /*  one radix-4 pass of the middle stage, n1 is the butterfly span */
+    q31_t R, S, T, U;
+    q31_t C1, C2, C3, out1, out2;
+    q15_t in;
+    uint32_t i3, i2, i1, i0, ic, n2, j;
+    
+    n2 = n1 >> 2u;
+    ic = 0u;
+    
+    for (j = 0u; j <= (n2 - 1u); j++)
+    {
+        /*  index calculation for the coefficients */
+        C1 = _SIMD32_OFFSET(pCoef16 + (2u * ic));
+        C2 = _SIMD32_OFFSET(pCoef16 + (4u * ic));
+        C3 = _SIMD32_OFFSET(pCoef16 + (6u * ic));
+        
+        /*  Twiddle coefficients index modifier */
+        ic = ic + twidCoefModifier;
+        
+        /*  Butterfly implementation */
+        for (i0 = j; i0 < fftLen; i0 += n1)
+        {
+            /*  index calculation for the input as, */
+            /*  pSrc16[i0 + 0], pSrc16[i0 + fftLen/4], pSrc16[i0 + fftLen/2], pSrc16[i0 + 3fftLen/4] */
+            i1 = i0 + n2;
+            i2 = i1 + n2;
+            i3 = i2 + n2;
+            
+            /*  Reading i0, i0+fftLen/2 inputs */
+            /* Read ya (real), xa(imag) input */
+            T = _SIMD32_OFFSET(pSrc16 + (2u * i0));
+            
+            /* Read yc (real), xc(imag) input */
+            S = _SIMD32_OFFSET(pSrc16 + (2u * i2));
+            
+            /* R = packed( (ya + yc), (xa + xc)) */
+            R = __QADD16(T, S);
+            
+            /* S = packed((ya - yc), (xa - xc)) */
+            S = __QSUB16(T, S);
+            
+            /*  Reading i0+fftLen/4 , i0+3fftLen/4 inputs */
+            /* Read yb (real), xb(imag) input */
+            T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
+            
+            /* Read yd (real), xd(imag) input */
+            U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
+            
+            /* T = packed( (yb + yd), (xb + xd)) */
+            T = __QADD16(T, U);
+            
+            /*  writing the butterfly processed i0 sample */
+            
+            /* xa' = xa + xb + xc + xd */
+            /* ya' = ya + yb + yc + yd */
+            out1 = __SHADD16(R, T);
+            in = ((int16_t) (out1 & 0xFFFF)) >> 1;
+            out1 = ((out1 >> 1) & 0xFFFF0000) | (in & 0xFFFF);
+            _SIMD32_OFFSET(pSrc16 + (2u * i0)) = out1;
+            
+            /* R = packed( (ya + yc) - (yb + yd), (xa + xc) - (xb + xd)) */
+            R = __SHSUB16(R, T);
+            
+#ifndef ARM_MATH_BIG_ENDIAN
+            
+            /* (ya-yb+yc-yd)* (si2) + (xa-xb+xc-xd)* co2 */
+            out1 = __SMUAD(C2, R) >> 16u;
+            
+            /* (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+            out2 = __SMUSDX(C2, R);
+            
+#else
+            
+            /* (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+            out1 = __SMUSDX(R, C2) >> 16u;
+            
+            /* (ya-yb+yc-yd)* (si2) + (xa-xb+xc-xd)* co2 */
+            out2 = __SMUAD(C2, R);
+            
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+            
+            /*  Reading i0+3fftLen/4 */
+            /* Read yb (real), xb(imag) input */
+            T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
+            
+            /*  writing the butterfly processed i0 + fftLen/4 sample */
+            /* xc' = (xa-xb+xc-xd)* co2 + (ya-yb+yc-yd)* (si2) */
+            /* yc' = (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+            _SIMD32_OFFSET(pSrc16 + (2u * i1)) =
+            ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+            
+            /*  Butterfly calculations */
+            
+            /* Read yd (real), xd(imag) input */
+            U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
+            
+            /* T = packed(yb-yd, xb-xd) */
+            T = __QSUB16(T, U);
+            
+#ifndef ARM_MATH_BIG_ENDIAN
+            
+            /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
+            R = __SHASX(S, T);
+            
+            /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
+            S = __SHSAX(S, T);
+            
+            
+            /*  Butterfly process for the i0+fftLen/2 sample */
+            out1 = __SMUAD(C1, S) >> 16u;
+            out2 = __SMUSDX(C1, S);
+            
+#else
+            
+            /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
+            R = __SHSAX(S, T);
+            
+            /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
+            S = __SHASX(S, T);
+            
+            
+            /*  Butterfly process for the i0+fftLen/2 sample */
+            out1 = __SMUSDX(S, C1) >> 16u;
+            out2 = __SMUAD(C1, S);
+            
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+            
+            /* xb' = (xa+yb-xc-yd)* co1 + (ya-xb-yc+xd)* (si1) */
+            /* yb' = (ya-xb-yc+xd)* co1 - (xa+yb-xc-yd)* (si1) */
+            _SIMD32_OFFSET(pSrc16 + (2u * i2)) =
+            ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+            
+            /*  Butterfly process for the i0+3fftLen/4 sample */
+            
+#ifndef ARM_MATH_BIG_ENDIAN
+            
+            out1 = __SMUAD(C3, R) >> 16u;
+            out2 = __SMUSDX(C3, R);
+            
+#else
+            
+            out1 = __SMUSDX(R, C3) >> 16u;
+            out2 = __SMUAD(C3, R);
+            
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+            
+            /* xd' = (xa-yb-xc+yd)* co3 + (ya+xb-yc-xd)* (si3) */
+            /* yd' = (ya+xb-yc-xd)* co3 - (xa-yb-xc+yd)* (si3) */
+            _SIMD32_OFFSET(pSrc16 + (2u * i3)) =
+            ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+        }
+    }
+#else
+    
+#endif /* #ifndef ARM_MATH_CM0 */
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline void arm_radix4_butterfly_q15_middle_packed(q15_t * pSrc16, uint32_t fftLen, uint32_t n1, const q31_t * pTwid) {
+#ifndef ARM_MATH_CM0
+    /*  one radix-4 pass of the middle stage, n1 is the butterfly span */
+    q31_t R, S, T, U;
+    q31_t C1, C2, C3, out1, out2;
+    q15_t in;
+    uint32_t i3, i2, i1, i0, n2, j;
+    
+    n2 = n1 >> 2u;
+    
+    for (j = 0u; j <= (n2 - 1u); j++)
+    {
+        /*  packed table, read in order */
+        C1 = *pTwid++;
+        C2 = *pTwid++;
+        C3 = *pTwid++;
+        
+        
+        /*  Butterfly implementation */
+        for (i0 = j; i0 < fftLen; i0 += n1)
+        {
+            /*  index calculation for the input as, */
+            /*  pSrc16[i0 + 0], pSrc16[i0 + fftLen/4], pSrc16[i0 + fftLen/2], pSrc16[i0 + 3fftLen/4] */
+            i1 = i0 + n2;
+            i2 = i1 + n2;
+            i3 = i2 + n2;
+            
+            /*  Reading i0, i0+fftLen/2 inputs */
+            /* Read ya (real), xa(imag) input */
+            T = _SIMD32_OFFSET(pSrc16 + (2u * i0));
+            
+            /* Read yc (real), xc(imag) input */
+            S = _SIMD32_OFFSET(pSrc16 + (2u * i2));
+            
+            /* R = packed( (ya + yc), (xa + xc)) */
+            R = __QADD16(T, S);
+            
+            /* S = packed((ya - yc), (xa - xc)) */
+            S = __QSUB16(T, S);
+            
+            /*  Reading i0+fftLen/4 , i0+3fftLen/4 inputs */
+            /* Read yb (real), xb(imag) input */
+            T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
+            
+            /* Read yd (real), xd(imag) input */
+            U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
+            
+            /* T = packed( (yb + yd), (xb + xd)) */
+            T = __QADD16(T, U);
+            
+            /*  writing the butterfly processed i0 sample */
+            
+            /* xa' = xa + xb + xc + xd */
+            /* ya' = ya + yb + yc + yd */
+            out1 = __SHADD16(R, T);
+            in = ((int16_t) (out1 & 0xFFFF)) >> 1;
+            out1 = ((out1 >> 1) & 0xFFFF0000) | (in & 0xFFFF);
+            _SIMD32_OFFSET(pSrc16 + (2u * i0)) = out1;
+            
+            /* R = packed( (ya + yc) - (yb + yd), (xa + xc) - (xb + xd)) */
+            R = __SHSUB16(R, T);
+            
+#ifndef ARM_MATH_BIG_ENDIAN
+            
+            /* (ya-yb+yc-yd)* (si2) + (xa-xb+xc-xd)* co2 */
+            out1 = __SMUAD(C2, R) >> 16u;
+            
+            /* (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+            out2 = __SMUSDX(C2, R);
+            
+#else
+            
+            /* (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+            out1 = __SMUSDX(R, C2) >> 16u;
+            
+            /* (ya-yb+yc-yd)* (si2) + (xa-xb+xc-xd)* co2 */
+            out2 = __SMUAD(C2, R);
+            
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+            
+            /*  Reading i0+3fftLen/4 */
+            /* Read yb (real), xb(imag) input */
+            T = _SIMD32_OFFSET(pSrc16 + (2u * i1));
+            
+            /*  writing the butterfly processed i0 + fftLen/4 sample */
+            /* xc' = (xa-xb+xc-xd)* co2 + (ya-yb+yc-yd)* (si2) */
+            /* yc' = (ya-yb+yc-yd)* co2 - (xa-xb+xc-xd)* (si2) */
+            _SIMD32_OFFSET(pSrc16 + (2u * i1)) =
+            ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+            
+            /*  Butterfly calculations */
+            
+            /* Read yd (real), xd(imag) input */
+            U = _SIMD32_OFFSET(pSrc16 + (2u * i3));
+            
+            /* T = packed(yb-yd, xb-xd) */
+            T = __QSUB16(T, U);
+            
+#ifndef ARM_MATH_BIG_ENDIAN
+            
+            /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
+            R = __SHASX(S, T);
+            
+            /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
+            S = __SHSAX(S, T);
+            
+            
+            /*  Butterfly process for the i0+fftLen/2 sample */
+            out1 = __SMUAD(C1, S) >> 16u;
+            out2 = __SMUSDX(C1, S);
+            
+#else
+            
+            /* R = packed((ya-yc) + (xb- xd) , (xa-xc) - (yb-yd)) */
+            R = __SHSAX(S, T);
+            
+            /* S = packed((ya-yc) - (xb- xd),  (xa-xc) + (yb-yd)) */
+            S = __SHASX(S, T);
+            
+            
+            /*  Butterfly process for the i0+fftLen/2 sample */
+            out1 = __SMUSDX(S, C1) >> 16u;
+            out2 = __SMUAD(C1, S);
+            
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+            
+            /* xb' = (xa+yb-xc-yd)* co1 + (ya-xb-yc+xd)* (si1) */
+            /* yb' = (ya-xb-yc+xd)* co1 - (xa+yb-xc-yd)* (si1) */
+            _SIMD32_OFFSET(pSrc16 + (2u * i2)) =
+            ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+            
+            /*  Butterfly process for the i0+3fftLen/4 sample */
+            
+#ifndef ARM_MATH_BIG_ENDIAN
+            
+            out1 = __SMUAD(C3, R) >> 16u;
+            out2 = __SMUSDX(C3, R);
+            
+#else
+            
+            out1 = __SMUSDX(R, C3) >> 16u;
+            out2 = __SMUAD(C3, R);
+            
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+            
+            /* xd' = (xa-yb-xc+yd)* co3 + (ya+xb-yc-xd)* (si3) */
+            /* yd' = (ya+xb-yc-xd)* co3 - (xa-yb-xc+yd)* (si3) */
+            _SIMD32_OFFSET(pSrc16 + (2u * i3)) =
+            ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
         }
+    }
+#else
+    
+#endif /* #ifndef ARM_MATH_CM0 */
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+inline void arm_radix4_butterfly_q15_stage2(q15_t * pSrc16, uint32_t fftLen, q15_t * pCoef16, uint32_t twidCoefModifier) {
+#ifndef ARM_MATH_CM0
+    uint32_t k;
+    
+    /*  Twiddle coefficients index modifier */
+    twidCoefModifier <<= 2u;
+    /*  Calculation of Middle stage */
+    for (k = fftLen / 4u; k > 4u; k >>= 2u)
+    {
+        arm_radix4_butterfly_q15_middle(pSrc16, fftLen, k, pCoef16, twidCoefModifier);
         /*  Twiddle coefficients index modifier */
         twidCoefModifier <<= 2u;
     }
@@ -575,6 +1266,137 @@ inline void arm_radix4_butterfly_q15_stage2(q15_t * pSrc16, uint32_t fftLen, q15
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+/*  R times the twiddle packed in C, halved like the radix-4 butterfly outputs */
+static inline q31_t radix8_twiddle_q15(q31_t C, q31_t R) __attribute__((always_inline, unused));
+static inline q31_t radix8_twiddle_q15(q31_t C, q31_t R) {
+    q31_t out1, out2;
+#ifndef ARM_MATH_BIG_ENDIAN
+    out1 = __SMUAD(C, R) >> 16u;
+    out2 = __SMUSDX(C, R);
+#else
+    out1 = __SMUSDX(R, C) >> 16u;
+    out2 = __SMUAD(C, R);
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+    return ((out2) & 0xFFFF0000) | (out1 & 0x0000FFFF);
+}
+
+/*  R rotated by the twiddle packed in C without scaling, for the W8 terms */
+static inline q31_t radix8_rotate_q15(q31_t C, q31_t R) __attribute__((always_inline, unused));
+static inline q31_t radix8_rotate_q15(q31_t C, q31_t R) {
+#ifndef ARM_MATH_BIG_ENDIAN
+    return __PKHBT(__SMUAD(C, R) >> 15u, __SMUSDX(C, R) >> 15u, 16);
+#else
+    return __PKHBT(__SMUSDX(R, C) >> 15u, __SMUAD(C, R) >> 15u, 16);
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+}
+
+/*
+ radix-4 butterfly on (A, B, C, D) for one half of a radix-8 butterfly, the
+ same arithmetic as the radix-4 middle pass. Outputs 0, 2, 1, 3 are written
+ to p0..p3 times W0, W2, W1, W3, W0 == 0 means no twiddle on output 0.
+ */
+static inline void radix8_quarter_q15(q31_t * p0, q31_t * p1, q31_t * p2, q31_t * p3, q31_t A, q31_t B, q31_t C, q31_t D,
+                                      q31_t W0, q31_t W1, q31_t W2, q31_t W3) __attribute__((always_inline, unused));
+static inline void radix8_quarter_q15(q31_t * p0, q31_t * p1, q31_t * p2, q31_t * p3, q31_t A, q31_t B, q31_t C, q31_t D,
+                                      q31_t W0, q31_t W1, q31_t W2, q31_t W3) {
+    q31_t R, S, T, out1;
+    q15_t in;
+    
+    /* R = a + c, S = a - c, T = b + d */
+    R = __QADD16(A, C);
+    S = __QSUB16(A, C);
+    T = __QADD16(B, D);
+    
+    /* output 0 = a + b + c + d */
+    out1 = __SHADD16(R, T);
+    if (W0) {
+        *p0 = radix8_twiddle_q15(W0, out1);
+    } else {
+        in = ((int16_t) (out1 & 0xFFFF)) >> 1;
+        *p0 = ((out1 >> 1) & 0xFFFF0000) | (in & 0xFFFF);
+    }
+    
+    /* output 2 = a - b + c - d */
+    R = __SHSUB16(R, T);
+    *p1 = radix8_twiddle_q15(W2, R);
+    
+    /* T = b - d */
+    T = __QSUB16(B, D);
+    
+#ifndef ARM_MATH_BIG_ENDIAN
+    R = __SHASX(S, T);
+    S = __SHSAX(S, T);
+#else
+    R = __SHSAX(S, T);
+    S = __SHASX(S, T);
+#endif /*      #ifndef ARM_MATH_BIG_ENDIAN     */
+    
+    /* output 1 = a - jb - c + jd, output 3 = a + jb - c - jd */
+    *p2 = radix8_twiddle_q15(W1, S);
+    *p3 = radix8_twiddle_q15(W3, R);
+}
+
+/*
+ One radix-8 pass, n1 is the butterfly span. pTwid holds W^j .. W^7j for
+ each of the n1/8 groups. The eight inputs are halved into a + b and
+ (a - b) * W8^k, then two radix-4 butterflies finish the even and odd
+ outputs. Outputs are stored in bit reversed order like the radix-4 passes
+ and every pass scales by 1/8, so two radix-8 passes stand in for the three
+ radix-4 middle passes with the same output format.
+ */
+#define RADIX8_W8_1 ((q31_t)0x5A825A82)   /* cos, sin of pi/4 */
+#define RADIX8_W8_3 ((q31_t)0x5A82A57E)   /* cos, sin of 3pi/4 */
+
+inline void arm_radix8_butterfly_q15_middle(q15_t * pSrc16, uint32_t fftLen, uint32_t n1, const q31_t * pTwid) {
+#ifndef ARM_MATH_CM0
+    q31_t *pSrc = (q31_t *) pSrc16;
+    q31_t x0, x1, x2, x3, x4, x5, x6, x7, b0, b1, b2, b3;
+    q31_t *p;
+    const q31_t *W;
+    uint32_t i0, j, n2;
+    
+    n2 = n1 >> 3u;
+    
+    for (j = 0u; j < n2; j++)
+    {
+        W = pTwid;
+        pTwid += 7u;
+        
+        for (i0 = j; i0 < fftLen; i0 += n1)
+        {
+            p = pSrc + i0;
+            
+            x0 = p[0u * n2];
+            x4 = p[4u * n2];
+            x1 = p[1u * n2];
+            x5 = p[5u * n2];
+            x2 = p[2u * n2];
+            x6 = p[6u * n2];
+            x3 = p[3u * n2];
+            x7 = p[7u * n2];
+            
+            /*  first radix-2 step, the odd half picks up W8^k */
+            b0 = __SHSUB16(x0, x4);
+            b1 = radix8_rotate_q15(RADIX8_W8_1, __SHSUB16(x1, x5));
+            b2 = __QSAX(0, __SHSUB16(x2, x6));    /* times -j */
+            b3 = radix8_rotate_q15(RADIX8_W8_3, __SHSUB16(x3, x7));
+            
+            /*  even outputs 0, 4, 2, 6 */
+            radix8_quarter_q15(p, p + n2, p + 2u * n2, p + 3u * n2,
+                               __SHADD16(x0, x4), __SHADD16(x1, x5), __SHADD16(x2, x6), __SHADD16(x3, x7),
+                               0, W[1], W[3], W[5]);
+            /*  odd outputs 1, 5, 3, 7 */
+            radix8_quarter_q15(p + 4u * n2, p + 5u * n2, p + 6u * n2, p + 7u * n2,
+                               b0, b1, b2, b3,
+                               W[0], W[2], W[4], W[6]);
+        }
+    }
+#endif /* #ifndef ARM_MATH_CM0 */
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 inline void arm_radix4_butterfly_q15_stage3(q15_t * pSrc16, uint32_t fftLen, q15_t * pCoef16, uint32_t twidCoefModifier) {
@@ -0,0 +1,181 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "fft_stream.h"
+
+// CRC-16/CCITT (polynomial 0x1021, initial 0xFFFF), a nibble at a time
+static const uint16_t crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static uint16_t crc16(const uint8_t *p, uint32_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*p >> 4)];
+        crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (*p++ & 0x0F)];
+    }
+    return crc;
+}
+
+static inline uint8_t * put16(uint8_t *p, uint16_t v)
+{
+    *p++ = v;
+    *p++ = v >> 8;
+    return p;
+}
+
+static inline uint8_t * put32(uint8_t *p, uint32_t v)
+{
+    return put16(put16(p, v), v >> 16);
+}
+
+static inline uint8_t * flush_run(uint8_t *p, uint16_t *run)
+{
+    if (*run) {
+        *p++ = 0;
+        *p++ = *run - 1;
+        *run = 0;
+    }
+    return p;
+}
+
+// zigzag varint of the difference, zeros are gathered into runs
+static inline uint8_t * put_delta(uint8_t *p, int32_t d, uint16_t *run)
+{
+    if (d == 0) {
+        if (++*run == 256) p = flush_run(p, run);
+        return p;
+    }
+    p = flush_run(p, run);
+    uint32_t v = ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+    while (v >= 0x80) {
+        *p++ = v | 0x80;
+        v >>= 7;
+    }
+    *p++ = v;
+    return p;
+}
+
+void FFTStream::begin(Print &p, uint8_t enc, uint16_t keyInterval)
+{
+    port = &p;
+    encoding = enc == FFT_STREAM_DELTA ? FFT_STREAM_DELTA : FFT_STREAM_RAW;
+    keyinterval = keyInterval ? keyInterval : 1;
+    keycount = 0;
+    prevcount = 0;
+    length = sent = 0;
+}
+
+// Numbers the frame and decides between delta and keyframe, false when
+// the last packet is still being sent
+bool FFTStream::start(uint8_t flags, uint16_t count)
+{
+    framecount++;
+    if (busy()) {
+        dropcount++;
+        return false;
+    }
+    if (encoding == FFT_STREAM_DELTA) {
+        if (keycount == 0 || count != prevcount || flags != prevflags) {
+            flags |= FFT_STREAM_KEYFRAME;
+            keycount = keyinterval;
+        }
+        keycount--;
+    }
+    prevflags = flags & (FFT_STREAM_DB | FFT_STREAM_BANDS);
+    prevcount = count;
+    buffer[0] = 0xA5;
+    buffer[1] = 0x5A;
+    buffer[2] = encoding | flags;
+    put16(buffer + 3, count);
+    put32(buffer + 5, framecount - 1);
+    return true;
+}
+
+// fills in the payload length and the crc and queues the packet
+void FFTStream::finish(uint8_t *p)
+{
+    put16(buffer + 9, p - (buffer + FFT_STREAM_HEADER));
+    p = put16(p, crc16(buffer + 2, p - (buffer + 2)));
+    length = p - buffer;
+    sent = 0;
+}
+
+bool FFTStream::write(const int16_t *values, uint16_t count, bool db)
+{
+    if (!port) return false;
+    if (count > 512) count = 512;
+    if (!start(db ? FFT_STREAM_DB : 0, count)) return false;
+    uint8_t *p = buffer + FFT_STREAM_HEADER;
+    if (encoding == FFT_STREAM_RAW) {
+        for (int i=0; i < count; i++) p = put16(p, values[i]);
+    } else {
+        const bool key = buffer[2] & FFT_STREAM_KEYFRAME;
+        uint16_t run = 0;
+        for (int i=0; i < count; i++) {
+            p = put_delta(p, key ? values[i] : values[i] - prev.bins[i], &run);
+            prev.bins[i] = values[i];
+        }
+        p = flush_run(p, &run);
+    }
+    finish(p);
+    return true;
+}
+
+bool FFTStream::writeBands(const uint32_t *bands, uint8_t count)
+{
+    if (!port) return false;
+    if (count > FFT_MAX_BANDS) count = FFT_MAX_BANDS;
+    if (!start(FFT_STREAM_BANDS, count)) return false;
+    uint8_t *p = buffer + FFT_STREAM_HEADER;
+    if (encoding == FFT_STREAM_RAW) {
+        for (int i=0; i < count; i++) p = put32(p, bands[i]);
+    } else {
+        const bool key = buffer[2] & FFT_STREAM_KEYFRAME;
+        uint16_t run = 0;
+        for (int i=0; i < count; i++) {
+            p = put_delta(p, key ? bands[i] : bands[i] - prev.bands[i], &run);
+            prev.bands[i] = bands[i];
+        }
+        p = flush_run(p, &run);
+    }
+    finish(p);
+    return true;
+}
+
+uint16_t FFTStream::update(void)
+{
+    if (!port || !busy()) return 0;
+    int room = port->availableForWrite();
+    if (room > 0) {
+        if (room > length - sent) room = length - sent;
+        sent += port->write(buffer + sent, room);
+    }
+    return length - sent;
+}
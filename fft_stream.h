@@ -0,0 +1,119 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef fft_stream_h_
+#define fft_stream_h_
+
+#include "Arduino.h"
+#include "analyze_fft1024_fast.h"
+
+// Binary spectrum packets for Serial or any other Print, instead of
+// printing read() as text. Each packet is, little endian:
+//   0xA5 0x5A      sync
+//   flags          encoding and the FFT_STREAM_ flags below
+//   count          uint16, values in the frame
+//   frame          uint32, counts every frame offered to write(), a gap
+//                  means frames were dropped
+//   length         uint16, payload bytes
+//   payload        the values
+//   crc            uint16, CRC-16/CCITT of everything after the sync
+// RAW payloads hold the values as int16 (uint32 for bands). DELTA payloads
+// hold each value's difference from the same value in the last packet as
+// a zigzag varint, a 0x00 byte followed by n stands for n + 1 unchanged
+// values. Keyframes are coded against zero, so they can be decoded alone.
+#define FFT_STREAM_RAW          0x00
+#define FFT_STREAM_DELTA        0x01
+#define FFT_STREAM_KEYFRAME     0x04
+#define FFT_STREAM_DB           0x08
+#define FFT_STREAM_BANDS        0x10
+
+#define FFT_STREAM_HEADER       11
+// largest packet, 512 deltas of up to 3 bytes
+#define FFT_STREAM_BUFFER_SIZE  (FFT_STREAM_HEADER + 512 * 3 + 2)
+
+class FFTStream
+{
+public:
+    FFTStream() : port(NULL), encoding(FFT_STREAM_DELTA), keyinterval(32), keycount(0),
+    prevflags(0), prevcount(0), length(0), sent(0), framecount(0), dropcount(0) { }
+    // keyInterval: every so many packets a DELTA stream sends a keyframe,
+    // so a receiver that lost bytes can pick the stream up again
+    void begin(Print &p, uint8_t encoding = FFT_STREAM_DELTA, uint16_t keyInterval = 32);
+    // Encodes a frame into the packet buffer, update() then sends it. If
+    // the last packet is still going out, the frame is dropped and false
+    // returned. Call it when available() is true.
+    bool write(const int16_t *values, uint16_t count, bool db = false);
+    bool write(AudioAnalyzeFFT1024_Fast &fft, bool db = false) {
+        return write(fft.output, 512, db);
+    }
+    bool writeBands(const uint32_t *bands, uint8_t count);
+    bool writeBands(AudioAnalyzeFFT1024_Fast &fft) {
+        return writeBands(fft.bandoutput, fft.bands());
+    }
+    // Hands the port as much of the packet as availableForWrite() says it
+    // takes without blocking. Call it from loop(), returns the bytes left.
+    uint16_t update(void);
+    bool busy(void) {
+        return sent < length;
+    }
+    // the packet being sent, for a DMA transfer instead of update()
+    const uint8_t * packet(void) {
+        return buffer;
+    }
+    uint16_t packetLength(void) {
+        return length;
+    }
+    // Call it when the DMA transfer of packet() has completed, busy()
+    // stays true and write() drops every frame until then
+    void packetSent(void) {
+        sent = length;
+    }
+    uint32_t frames(void) {
+        return framecount;
+    }
+    uint32_t dropped(void) {
+        return dropcount;
+    }
+private:
+    bool start(uint8_t flags, uint16_t count);
+    void finish(uint8_t *p);
+    Print *port;
+    uint8_t encoding;
+    uint16_t keyinterval, keycount;
+    // the last packet's values, the reference for the next delta
+    union {
+        int16_t bins[512];
+        uint32_t bands[FFT_MAX_BANDS];
+    } prev;
+    uint8_t prevflags;
+    uint16_t prevcount;
+    uint8_t buffer[FFT_STREAM_BUFFER_SIZE];
+    uint16_t length, sent;
+    uint32_t framecount, dropcount;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "fft_window.h"
+#include <math.h>
+
+static int16_t window_q15(float w)
+{
+    if (w <= 0.0f) return 0;
+    if (w >= 1.0f) return 32767;
+    return (int16_t)(w * 32767.0f + 0.5f);
+}
+
+// zeroth order modified Bessel function of the first kind, power series
+static float bessel_i0(float x)
+{
+    float sum = 1.0f, term = 1.0f;
+    const float q = x * x * 0.25f;
+    for (int k=1; k < 50; k++) {
+        term *= q / ((float)k * (float)k);
+        sum += term;
+        if (term < sum * 1e-8f) break;
+    }
+    return sum;
+}
+
+// position of sample n relative to the window center, -1 at the first
+// sample and 0 in the middle
+static inline float window_position(uint16_t n, uint16_t size)
+{
+    return (2.0f * n) / (float)(size - 1) - 1.0f;
+}
+
+void generateWindowKaiser(int16_t *half, uint16_t size, float beta)
+{
+    const float norm = 1.0f / bessel_i0(beta);
+    for (uint16_t n=0; n < size/2; n++) {
+        float x = window_position(n, size);
+        half[n] = window_q15(bessel_i0(beta * sqrtf(1.0f - x * x)) * norm);
+    }
+}
+
+void generateWindowGaussian(int16_t *half, uint16_t size, float sigma)
+{
+    if (sigma <= 0.0f) sigma = 0.4f;
+    for (uint16_t n=0; n < size/2; n++) {
+        float x = window_position(n, size) / sigma;
+        half[n] = window_q15(expf(-0.5f * x * x));
+    }
+}
+
+void generateWindowTukey(int16_t *half, uint16_t size, float alpha)
+{
+    if (alpha < 0.0f) alpha = 0.0f;
+    if (alpha > 1.0f) alpha = 1.0f;
+    // the taper covers alpha/2 of the window on each side
+    const float edge = alpha * (size - 1) * 0.5f;
+    for (uint16_t n=0; n < size/2; n++) {
+        float w = 1.0f;
+        if (n < edge) w = 0.5f * (1.0f - cosf((float)M_PI * n / edge));
+        half[n] = window_q15(w);
+    }
+}
+
+float windowGain(const int16_t *window, uint16_t size, bool symmetric)
+{
+    if (!window || !size) return 1.0f;
+    const uint16_t n = symmetric ? size/2 : size;
+    int32_t sum = 0;
+    for (uint16_t i=0; i < n; i++) {
+        sum += window[i];
+    }
+    return (float)sum / ((float)n * 32768.0f);
+}
@@ -0,0 +1,52 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef fft_window_h_
+#define fft_window_h_
+
+#include "Arduino.h"
+
+// Window generators for symmetric windows of any even size. They fill
+// half[] with the first size/2 values in Q15, the second half is the
+// mirror image, so the table is half the size of a full one and can be
+// passed straight to windowSymmetric(). half[] must be 4 byte aligned.
+// Generation uses floats and is meant for setup(), not the audio update.
+
+// Kaiser window, beta sets the trade between main lobe width and side
+// lobe level, 0 is rectangular, about 8.6 matches Blackman-Harris.
+void generateWindowKaiser(int16_t *half, uint16_t size, float beta);
+// Gaussian window, sigma is the standard deviation relative to half the
+// window length, typically 0.3 to 0.5.
+void generateWindowGaussian(int16_t *half, uint16_t size, float sigma);
+// Tukey (tapered cosine) window, alpha is the tapered fraction, 0 is
+// rectangular and 1 is Hann.
+void generateWindowTukey(int16_t *half, uint16_t size, float alpha);
+
+// coherent gain of a window, the mean of its values as a fraction of full
+// scale. An uncalibrated read() of a full scale sine returns about this.
+float windowGain(const int16_t *window, uint16_t size, bool symmetric);
+
+#endif